@@ -0,0 +1,93 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "allocations.h"
+
+#include <QFile>
+
+#include <atomic>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#if defined(__GLIBC__)
+// The benchmark executable exports these, so that the thumbnailer
+// plugins and every library they use call them instead of the ones in
+// libc, which are still reachable under their internal names.
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+}
+
+static std::atomic<quint64> allocationCount;
+
+extern "C" void *malloc(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *pointer, size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+#endif
+
+bool Allocations::isCounting()
+{
+#if defined(__GLIBC__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+quint64 Allocations::count()
+{
+#if defined(__GLIBC__)
+    return allocationCount.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+bool Allocations::resetPeakResidentSize()
+{
+    // Linux resets VmHWM to the current RSS when asked to clear 5
+    QFile clearRefs(QStringLiteral("/proc/self/clear_refs"));
+    return clearRefs.open(QIODevice::WriteOnly) && clearRefs.write("5") == 1;
+}
+
+qint64 Allocations::peakResidentSize()
+{
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (status.open(QIODevice::ReadOnly)) {
+        while (!status.atEnd()) {
+            const QByteArray line = status.readLine();
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+            }
+        }
+    }
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+qint64 Allocations::peakChildResidentSize()
+{
+    rusage usage;
+    getrusage(RUSAGE_CHILDREN, &usage);
+    return usage.ru_maxrss;
+}
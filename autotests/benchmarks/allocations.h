@@ -0,0 +1,46 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _ALLOCATIONS_H_
+#define _ALLOCATIONS_H_
+
+#include <QtGlobal>
+
+/**
+ * Process-wide counters for the benchmarks: heap allocations, counted
+ * by wrapping malloc() with glibc, and the peak resident set size.
+ */
+namespace Allocations
+{
+/**
+ * False where allocations cannot be counted; count() is then always 0.
+ */
+bool isCounting();
+
+/**
+ * Calls to malloc(), calloc() and realloc() so far, from any library.
+ */
+quint64 count();
+
+/**
+ * Start measuring the peak RSS of this process from the current RSS.
+ * Returns false if the system cannot reset it.
+ */
+bool resetPeakResidentSize();
+
+/**
+ * Peak RSS of this process in KiB, since the last reset if there was
+ * one.
+ */
+qint64 peakResidentSize();
+
+/**
+ * Largest peak RSS of any child waited for so far, in KiB.
+ */
+qint64 peakChildResidentSize();
+}
+
+#endif
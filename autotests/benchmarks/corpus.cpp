@@ -0,0 +1,532 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "corpus.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+
+namespace
+{
+// Scaled points, the DVI unit with the num/den used below
+const qint32 point = 65536;
+
+void putBigEndian16(QByteArray &data, quint16 value)
+{
+    data += char(value >> 8);
+    data += char(value);
+}
+
+void putBigEndian32(QByteArray &data, quint32 value)
+{
+    data += char(value >> 24);
+    data += char(value >> 16);
+    data += char(value >> 8);
+    data += char(value);
+}
+
+void setBigEndian32(QByteArray &data, int offset, quint32 value)
+{
+    data[offset] = char(value >> 24);
+    data[offset + 1] = char(value >> 16);
+    data[offset + 2] = char(value >> 8);
+    data[offset + 3] = char(value);
+}
+
+void putLittleEndian32(QByteArray &data, quint32 value)
+{
+    data += char(value);
+    data += char(value >> 8);
+    data += char(value >> 16);
+    data += char(value >> 24);
+}
+
+// A few dozen coloured boxes, laid out from @p seed
+struct Box {
+    int x;
+    int y;
+    int width;
+    int height;
+    double red;
+    double green;
+    double blue;
+};
+
+QList<Box> boxes(int width, int height, int seed)
+{
+    QList<Box> result;
+    for (int i = 0; i < 24; ++i) {
+        result.append({(i * 37 + seed * 11) % width,
+                       (i * 53 + seed * 7) % height,
+                       width / 6,
+                       height / 8,
+                       (i * 29 % 100) / 100.0,
+                       (i * 47 % 100) / 100.0,
+                       (i * 71 % 100) / 100.0});
+    }
+    return result;
+}
+
+QByteArray postScriptDrawing(int width, int height, int seed)
+{
+    QByteArray data;
+    for (const Box &box : boxes(width, height, seed)) {
+        data += QString::asprintf("%.2f %.2f %.2f setrgbcolor %d %d %d %d rectfill\n",
+                                  box.red, box.green, box.blue, box.x, box.y, box.width, box.height)
+                    .toLatin1();
+    }
+    data += "0 setgray /Helvetica findfont 24 scalefont setfont\n";
+    data += "36 36 moveto (Page " + QByteArray::number(seed) + ") show\n";
+    return data;
+}
+
+QByteArray pdfDrawing(int width, int height, int seed)
+{
+    QByteArray data;
+    for (const Box &box : boxes(width, height, seed)) {
+        data += QString::asprintf("%.2f %.2f %.2f rg %d %d %d %d re f\n",
+                                  box.red, box.green, box.blue, box.x, box.y, box.width, box.height)
+                    .toLatin1();
+    }
+    return data;
+}
+
+// A stream object with the entries @p entries besides its length
+QByteArray pdfStream(const QByteArray &entries, const QByteArray &data)
+{
+    return "<< " + entries + (entries.isEmpty() ? "" : " ") + "/Length " + QByteArray::number(data.size()) + " >>\nstream\n" + data + "\nendstream";
+}
+
+// A PDF file of @p objects, numbered from 1, the first being the catalog
+QByteArray pdfFile(const QList<QByteArray> &objects)
+{
+    QByteArray data = "%PDF-1.4\n%\xe2\xe3\xcf\xd3\n";
+    QList<int> offsets;
+    for (const QByteArray &body : objects) {
+        offsets.append(data.size());
+        data += QByteArray::number(offsets.size()) + " 0 obj\n" + body + "\nendobj\n";
+    }
+
+    const int xref = data.size();
+    data += "xref\n0 " + QByteArray::number(offsets.size() + 1) + "\n0000000000 65535 f \n";
+    for (int offset : std::as_const(offsets)) {
+        data += QString::asprintf("%010d 00000 n \n", offset).toLatin1();
+    }
+    data += "trailer\n<< /Size " + QByteArray::number(offsets.size() + 1) + " /Root 1 0 R >>\nstartxref\n" + QByteArray::number(xref) + "\n%%EOF\n";
+    return data;
+}
+
+QByteArray png(int width, int height)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            image.setPixel(x, y, qRgb(x * 255 / width, y * 255 / height, 128));
+        }
+    }
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    return data;
+}
+}
+
+QByteArray Corpus::postScript(int pages)
+{
+    QByteArray data = "%!PS-Adobe-3.0\n"
+                      "%%Creator: thumbnailer_bench\n"
+                      "%%Title: benchmark\n"
+                      "%%BoundingBox: 0 0 612 792\n"
+                      "%%Pages: "
+        + QByteArray::number(pages)
+        + "\n"
+          "%%EndComments\n"
+          "%%BeginProlog\n"
+          "%%EndProlog\n";
+    for (int page = 1; page <= pages; ++page) {
+        data += "%%Page: " + QByteArray::number(page) + ' ' + QByteArray::number(page) + '\n';
+        data += postScriptDrawing(612, 792, page);
+        data += "showpage\n";
+    }
+    data += "%%Trailer\n%%EOF\n";
+    return data;
+}
+
+QByteArray Corpus::comments(int pages)
+{
+    // Keywords the parser does not know, sharing prefixes with the last
+    // ones it compared lines against before it looked them up
+    const char *const headerComments[] = {
+        "%%DocumentFonts: Times-Roman Helvetica",
+        "%%DocumentNeededResources: font Times-Roman",
+        "%%+ font Helvetica",
+        "%%DocumentSuppliedResources: procset Adobe_level2_AI5 1.2 0",
+        "%%DocumentProcessColors: Cyan Magenta Yellow Black",
+        "%%DocumentCustomColors: (PANTONE 185 C)",
+        "%%DocumentFiles: placed.tif",
+        "%%DocumentPaperSizes: Letter",
+        "%%Requirements: color",
+        "%%AI5_FileFormat 3",
+        "%%CMYKCustomColor: 0 1 1 0 (PANTONE 185 C)",
+    };
+    const char *const pageComments[] = {
+        "%%IncludeResource: font Times-Roman",
+        "%%IncludeFeature: *InputSlot Upper",
+        "%%IncludeFont: Helvetica",
+        "%%PageResources: font Times-Roman",
+        "%%PageProcessColors: Cyan Magenta",
+        "%%PageCustomColors: (PANTONE 185 C)",
+        "%%PaperSize: Letter",
+        "%%PageMedia: Plain",
+        "%%BeginObject: group",
+        "%%EndObject",
+        "%%PlateColor: Cyan",
+        "%%AI5_BeginLayer",
+        "%%AI5_EndLayer--",
+    };
+
+    QByteArray data = "%!PS-Adobe-3.0\n"
+                      "%%Creator: thumbnailer_bench\n"
+                      "%%Title: comments\n"
+                      "%%BoundingBox: 0 0 612 792\n"
+                      "%%Pages: "
+        + QByteArray::number(pages) + '\n';
+    for (int i = 0; i < 8; ++i) {
+        for (const char *comment : headerComments) {
+            data += comment;
+            data += '\n';
+        }
+    }
+    data += "%%EndComments\n"
+            "%%BeginProlog\n"
+            "%%EndProlog\n"
+            "%%BeginSetup\n"
+            "%%IncludeFeature: *PageSize Letter\n"
+            "%%EndSetup\n";
+    for (int page = 1; page <= pages; ++page) {
+        data += "%%Page: " + QByteArray::number(page) + ' ' + QByteArray::number(page) + '\n';
+        data += "%%BeginPageSetup\n"
+                "%%PageOrientation: Portrait\n"
+                "%%PageBoundingBox: 0 0 612 792\n"
+                "%%EndPageSetup\n";
+        for (int i = 0; i < 4; ++i) {
+            for (const char *comment : pageComments) {
+                data += comment;
+                data += '\n';
+            }
+        }
+        data += "0 0 moveto 612 792 lineto stroke\n"
+                "showpage\n"
+                "%%PageTrailer\n";
+    }
+    data += "%%Trailer\n%%EOF\n";
+    return data;
+}
+
+QByteArray Corpus::eps(int width, int height)
+{
+    return "%!PS-Adobe-3.0 EPSF-3.0\n"
+           "%%Creator: thumbnailer_bench\n"
+           "%%BoundingBox: 0 0 "
+        + QByteArray::number(width) + ' ' + QByteArray::number(height)
+        + "\n"
+          "%%EndComments\n"
+        + postScriptDrawing(width, height, 1) + "%%EOF\n";
+}
+
+QByteArray Corpus::epsi(int width, int height)
+{
+    // A 1 bit checkerboard preview, one hex line per row
+    QByteArray preview = "%%BeginPreview: " + QByteArray::number(width) + ' ' + QByteArray::number(height) + " 1 " + QByteArray::number(height) + '\n';
+    const int rowBytes = (width + 7) / 8;
+    for (int y = 0; y < height; ++y) {
+        QByteArray row(rowBytes, '\0');
+        for (int x = 0; x < rowBytes; ++x) {
+            row[x] = ((x + y / 8) % 2) ? char(0xff) : char(0x00);
+        }
+        preview += "% " + row.toHex() + '\n';
+    }
+    preview += "%%EndPreview\n";
+
+    return "%!PS-Adobe-3.0 EPSF-3.0\n"
+           "%%Creator: thumbnailer_bench\n"
+           "%%BoundingBox: 0 0 "
+        + QByteArray::number(width) + ' ' + QByteArray::number(height)
+        + "\n"
+          "%%EndComments\n"
+        + preview + postScriptDrawing(width, height, 1) + "%%EOF\n";
+}
+
+// Rules only, so that dvips needs no fonts
+QByteArray Corpus::dvi(int pages)
+{
+    const quint32 num = 25400000;
+    const quint32 den = 473628672;
+    const quint32 mag = 1000;
+
+    QByteArray data;
+    data += char(247); // pre
+    data += char(2);
+    putBigEndian32(data, num);
+    putBigEndian32(data, den);
+    putBigEndian32(data, mag);
+    data += char(0); // no comment
+
+    qint32 previous = -1;
+    for (int page = 0; page < pages; ++page) {
+        const qint32 bop = data.size();
+        data += char(139); // bop
+        putBigEndian32(data, page + 1);
+        for (int i = 1; i < 10; ++i) {
+            putBigEndian32(data, 0);
+        }
+        putBigEndian32(data, quint32(previous));
+        previous = bop;
+
+        for (int i = 0; i < 12; ++i) {
+            data += char(141); // push
+            data += char(160); // down4
+            putBigEndian32(data, ((i * 53 + page * 7) % 700) * point);
+            data += char(146); // right4
+            putBigEndian32(data, ((i * 37 + page * 11) % 500) * point);
+            data += char(137); // put_rule
+            putBigEndian32(data, (10 + i) * point);
+            putBigEndian32(data, (50 + 5 * i) * point);
+            data += char(142); // pop
+        }
+        data += char(140); // eop
+    }
+
+    const qint32 post = data.size();
+    data += char(248); // post
+    putBigEndian32(data, quint32(previous));
+    putBigEndian32(data, num);
+    putBigEndian32(data, den);
+    putBigEndian32(data, mag);
+    putBigEndian32(data, 795 * point); // 11in
+    putBigEndian32(data, 614 * point); // 8.5in
+    putBigEndian16(data, 1);
+    putBigEndian16(data, pages);
+
+    data += char(249); // post_post
+    putBigEndian32(data, post);
+    data += char(2);
+    // At least four 223s, up to a multiple of four bytes
+    for (int padding = 0; padding < 4 || data.size() % 4 != 0; ++padding) {
+        data += char(223);
+    }
+    return data;
+}
+
+QByteArray Corpus::pdf(int pages)
+{
+    QList<QByteArray> objects;
+    QByteArray kids;
+    for (int page = 0; page < pages; ++page) {
+        kids += QByteArray::number(3 + 2 * page) + " 0 R ";
+    }
+    objects.append("<< /Type /Catalog /Pages 2 0 R >>");
+    objects.append("<< /Type /Pages /Kids [" + kids + "] /Count " + QByteArray::number(pages) + " >>");
+    for (int page = 0; page < pages; ++page) {
+        const QByteArray content = pdfDrawing(612, 792, page + 1);
+        objects.append("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] /Contents " + QByteArray::number(4 + 2 * page) + " 0 R >>");
+        objects.append(pdfStream("", content));
+    }
+    return pdfFile(objects);
+}
+
+// A marketing page: a full bleed photograph to be interpolated, boxes
+// blended over it, overprinted CMYK bars and text in fonts that are not
+// embedded
+QByteArray Corpus::brochure()
+{
+    // Noise over gradients, which compresses about as badly as a photograph
+    const int width = 1600;
+    const int height = 1200;
+    QByteArray pixels(width * height * 3, Qt::Uninitialized);
+    quint32 noise = 1;
+    char *pixel = pixels.data();
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            noise = noise * 1664525 + 1013904223;
+            const int grain = int(noise >> 27) - 16;
+            *pixel++ = char(qBound(0, x * 255 / width + grain, 255));
+            *pixel++ = char(qBound(0, y * 255 / height + grain, 255));
+            *pixel++ = char(qBound(0, (x + y) * 255 / (width + height) + grain, 255));
+        }
+    }
+    // Without the length qCompress() puts before the zlib stream
+    const QByteArray image = qCompress(pixels).mid(4);
+
+    QByteArray content = "q 612 0 0 792 0 0 cm /Photo Do Q\n";
+    content += "q /Blend gs\n" + pdfDrawing(612, 792, 1) + "Q\n";
+    content += "q /Overprint gs\n";
+    for (int bar = 0; bar < 12; ++bar) {
+        content += QString::asprintf("%.2f %.2f %.2f 0 k %d 0 %d 792 re f\n",
+                                     (bar * 29 % 100) / 100.0, (bar * 47 % 100) / 100.0, (bar * 71 % 100) / 100.0, bar * 51, 24)
+                       .toLatin1();
+    }
+    content += "Q\n";
+    content += "BT /Title 48 Tf 1 g 48 700 Td (Spring Collection) Tj ET\n";
+    for (int line = 0; line < 30; ++line) {
+        content += "BT /Body 10 Tf 0 g 48 " + QByteArray::number(640 - 14 * line)
+            + " Td (Soft fabrics, bright colours and a fit made for every day of the season.) Tj ET\n";
+    }
+
+    const QList<QByteArray> objects = {
+        "<< /Type /Catalog /Pages 2 0 R >>",
+        "<< /Type /Pages /Kids [3 0 R] /Count 1 >>",
+        "<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] /Group << /S /Transparency /CS /DeviceRGB >>"
+        " /Resources << /XObject << /Photo 5 0 R >> /ExtGState << /Blend 6 0 R /Overprint 7 0 R >> /Font << /Title 8 0 R /Body 9 0 R >> >>"
+        " /Contents 4 0 R >>",
+        pdfStream("", content),
+        pdfStream("/Type /XObject /Subtype /Image /Width " + QByteArray::number(width) + " /Height " + QByteArray::number(height)
+                      + " /ColorSpace /DeviceRGB /BitsPerComponent 8 /Interpolate true /Filter /FlateDecode",
+                  image),
+        "<< /Type /ExtGState /ca 0.55 /CA 0.55 /BM /Multiply >>",
+        "<< /Type /ExtGState /OP true /op true /OPM 1 >>",
+        "<< /Type /Font /Subtype /Type1 /BaseFont /BrandDisplay-Bold >>",
+        "<< /Type /Font /Subtype /Type1 /BaseFont /BrandText-Regular >>",
+    };
+    return pdfFile(objects);
+}
+
+// 64 bit little endian, a REND block, the TEST thumbnail and ENDB
+QByteArray Corpus::blend(int width, int height)
+{
+    const auto blockHeader = [](QByteArray &data, const char *code, quint32 size) {
+        data += QByteArray(code, 4);
+        putLittleEndian32(data, size);
+        data += QByteArray(8, '\0'); // old memory address
+        putLittleEndian32(data, 0); // SDNA index
+        putLittleEndian32(data, 1); // count
+    };
+
+    QByteArray data = "BLENDER-v300";
+    blockHeader(data, "REND", 16);
+    data += QByteArray(16, '\0');
+
+    blockHeader(data, "TEST", 8 + width * height * 4);
+    putLittleEndian32(data, width);
+    putLittleEndian32(data, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            data += char(x * 255 / width);
+            data += char(y * 255 / height);
+            data += char(128);
+            data += char(255);
+        }
+    }
+
+    blockHeader(data, "ENDB", 0);
+    return data;
+}
+
+// A Palm database with the MOBI header record, one text record and
+// the cover image, referenced from EXTH record 201.
+QByteArray Corpus::mobi(int width, int height)
+{
+    const QByteArray text = "<html><head></head><body><p>Benchmark</p></body></html>";
+    const QByteArray title = "Benchmark";
+
+    const int mobiHeaderLength = 232;
+    QByteArray mobiHeader(mobiHeaderLength, '\0');
+    mobiHeader.replace(0, 4, "MOBI");
+    setBigEndian32(mobiHeader, 4, mobiHeaderLength);
+    setBigEndian32(mobiHeader, 8, 2); // book
+    setBigEndian32(mobiHeader, 12, 65001); // UTF-8
+    setBigEndian32(mobiHeader, 16, 1); // unique id
+    setBigEndian32(mobiHeader, 20, 6); // file version
+    for (int offset = 24; offset < 64; offset += 4) {
+        setBigEndian32(mobiHeader, offset, 0xffffffff); // no indexes
+    }
+    setBigEndian32(mobiHeader, 64, 2); // first non-book record
+    setBigEndian32(mobiHeader, 68, 16 + mobiHeaderLength + 24); // title offset
+    setBigEndian32(mobiHeader, 72, title.size());
+    setBigEndian32(mobiHeader, 76, 9); // English
+    setBigEndian32(mobiHeader, 88, 6); // minimum version
+    setBigEndian32(mobiHeader, 92, 2); // first image record
+    setBigEndian32(mobiHeader, 112, 0x40); // has EXTH
+    setBigEndian32(mobiHeader, 152, 0xffffffff); // no DRM
+
+    QByteArray record0;
+    putBigEndian16(record0, 1); // no compression
+    putBigEndian16(record0, 0);
+    putBigEndian32(record0, text.size());
+    putBigEndian16(record0, 1); // text records
+    putBigEndian16(record0, 4096);
+    putBigEndian16(record0, 0); // no encryption
+    putBigEndian16(record0, 0);
+    record0 += mobiHeader;
+    record0 += "EXTH";
+    putBigEndian32(record0, 24);
+    putBigEndian32(record0, 1);
+    putBigEndian32(record0, 201); // cover offset
+    putBigEndian32(record0, 12);
+    putBigEndian32(record0, 0);
+    record0 += title;
+    record0 += QByteArray(2 + (4 - (record0.size() + 2) % 4) % 4, '\0');
+
+    const QList<QByteArray> records = {record0, text, png(width, height)};
+
+    QByteArray data = title;
+    data += QByteArray(32 - title.size(), '\0');
+    data += QByteArray(4 + 6 * 4, '\0'); // attributes, version, dates, info
+    data += "BOOKMOBI";
+    putBigEndian32(data, records.size() * 2 - 1);
+    putBigEndian32(data, 0);
+    putBigEndian16(data, records.size());
+
+    int offset = data.size() + records.size() * 8 + 2;
+    for (int i = 0; i < records.size(); ++i) {
+        putBigEndian32(data, offset);
+        putBigEndian32(data, 2 * i); // attributes and unique id
+        offset += records.at(i).size();
+    }
+    data += QByteArray(2, '\0');
+    for (const QByteArray &record : records) {
+        data += record;
+    }
+    return data;
+}
+
+QList<Corpus::Sample> Corpus::generate(const QString &directory)
+{
+    struct Document {
+        const char *name;
+        const char *fileName;
+        const char *mimeType;
+        QByteArray data;
+    };
+    const Document documents[] = {
+        {"ps-1", "page.ps", "application/postscript", postScript(1)},
+        {"ps-50", "pages.ps", "application/postscript", postScript(50)},
+        {"eps", "drawing.eps", "image/x-eps", eps(400, 300)},
+        {"epsi", "drawing.epsi", "image/x-eps", epsi(400, 300)},
+        {"dvi-1", "page.dvi", "application/x-dvi", dvi(1)},
+        {"dvi-20", "pages.dvi", "application/x-dvi", dvi(20)},
+        {"pdf-1", "page.pdf", "application/pdf", pdf(1)},
+        {"pdf-50", "pages.pdf", "application/pdf", pdf(50)},
+        {"brochure", "brochure.pdf", "application/pdf", brochure()},
+        {"blend", "scene.blend", "application/x-blender", blend(128, 128)},
+        {"mobi", "book.mobi", "application/x-mobipocket-ebook", mobi(600, 800)},
+    };
+
+    QList<Sample> samples;
+    const QDir dir(directory);
+    for (const Document &document : documents) {
+        const QString path = dir.filePath(QLatin1String(document.fileName));
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(document.data) != document.data.size()) {
+            continue;
+        }
+        samples.append({QLatin1String(document.name), path, QLatin1String(document.mimeType)});
+    }
+    return samples;
+}
@@ -0,0 +1,49 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _CORPUS_H_
+#define _CORPUS_H_
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+/**
+ * Generators for the benchmark corpus. Every document is built from
+ * scratch and depends on nothing but its parameters, so runs on
+ * different machines measure the same input without fetching anything.
+ */
+namespace Corpus
+{
+struct Sample {
+    QString name;
+    QString fileName;
+    QString mimeType;
+};
+
+/**
+ * Write the whole corpus into @p directory.
+ */
+QList<Sample> generate(const QString &directory);
+
+QByteArray postScript(int pages);
+
+/**
+ * PostScript of @p pages which is almost all DSC comments, many of them
+ * of keywords the DSC parser does not know.
+ */
+QByteArray comments(int pages);
+
+QByteArray eps(int width, int height);
+QByteArray epsi(int width, int height);
+QByteArray dvi(int pages);
+QByteArray pdf(int pages);
+QByteArray brochure();
+QByteArray blend(int width, int height);
+QByteArray mobi(int width, int height);
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QElapsedTimer>
+#include <QTest>
+
+#include "corpus.h"
+#include "dscparse_adapter.h"
+
+/**
+ * Throughput of the DSC parser of the ps thumbnailer on its own, fed in
+ * chunks of several sizes. "header" stops after the header comments,
+ * as GSCreator does; "full" scans the whole document.
+ */
+class DscParseBench : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void scan_data();
+    void scan();
+};
+
+namespace
+{
+class HeaderEndHandler : public KDSCCommentHandler
+{
+public:
+    bool endComments = false;
+
+    void comment(Name name) override
+    {
+        if (name == EndPreview || name == BeginProlog || name == Page) {
+            endComments = true;
+        }
+    }
+};
+}
+
+void DscParseBench::scan_data()
+{
+    QTest::addColumn<QByteArray>("document");
+    QTest::addColumn<int>("chunkSize");
+    QTest::addColumn<bool>("headerOnly");
+
+    const struct {
+        const char *name;
+        QByteArray data;
+    } documents[] = {
+        {"ps-500", Corpus::postScript(500)},
+        {"comments-500", Corpus::comments(500)},
+        {"eps", Corpus::eps(400, 300)},
+        {"epsi", Corpus::epsi(400, 300)},
+    };
+
+    for (const auto &document : documents) {
+        for (int chunkSize : {64, 4096, 65536}) {
+            QTest::addRow("%s/%d/full", document.name, chunkSize) << document.data << chunkSize << false;
+            QTest::addRow("%s/%d/header", document.name, chunkSize) << document.data << chunkSize << true;
+        }
+    }
+}
+
+void DscParseBench::scan()
+{
+    QFETCH(QByteArray, document);
+    QFETCH(int, chunkSize);
+    QFETCH(bool, headerOnly);
+
+    qint64 bytes = 0;
+    qint64 nanoseconds = 0;
+
+    QBENCHMARK {
+        QElapsedTimer timer;
+        timer.start();
+
+        KDSC dsc;
+        HeaderEndHandler handler;
+        if (headerOnly) {
+            dsc.setCommentHandler(&handler);
+        }
+
+        char *data = document.data();
+        qsizetype offset = 0;
+        while (offset < document.size() && !handler.endComments) {
+            const unsigned int count = qMin<qsizetype>(chunkSize, document.size() - offset);
+            dsc.scanData(data + offset, count);
+            offset += count;
+        }
+
+        nanoseconds += timer.nsecsElapsed();
+        bytes += offset;
+    }
+
+    qInfo().noquote() << QStringLiteral("%1: %2 MB/s").arg(QLatin1String(QTest::currentDataTag())).arg(nanoseconds ? bytes * 1e3 / nanoseconds : 0.0, 0, 'f', 1);
+}
+
+QTEST_MAIN(DscParseBench)
+
+#include "dscparsebench.moc"
@@ -0,0 +1,201 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "corpus.h"
+#include "gsprocess.h"
+
+/**
+ * The draft profile of the ps thumbnailer against full rendering, over
+ * a generated marketing page heavy in images, transparency, overprint
+ * and fonts that are not embedded. Each thumbnail size reports the time
+ * per document of both, the speedup of the draft and how far it is from
+ * the full rendering, as the mean structural similarity of their luma.
+ * gs must be in PATH.
+ */
+class GsDraftBench : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void render_data();
+    void render();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_fileName;
+
+    // Milliseconds per document and image of the full rendering, by size
+    QHash<int, double> m_fullTimes;
+    QHash<int, QImage> m_fullImages;
+};
+
+namespace
+{
+// As GSCreator builds them for a US letter page
+QList<QByteArray> pdfArguments(const QByteArray &fileName, int size)
+{
+    const double scale = qMin(size / 612.0, size / 792.0);
+    return {"gs",
+            "-sDEVICE=png16m",
+            "-sOutputFile=-",
+            "-dSAFER",
+            "-dBATCH",
+            "-dNOPAUSE",
+            "-dFirstPage=1",
+            "-dLastPage=1",
+            "-dPrinted=false",
+            "-r" + QByteArray::number(72 * scale, 'f', 3),
+            "-g" + QByteArray::number(qRound(612 * scale)) + 'x' + QByteArray::number(qRound(792 * scale)),
+            "-dPDFFitPage",
+            "-dTextAlphaBits=4",
+            "-dGraphicsAlphaBits=4",
+            "-q",
+            fileName};
+}
+
+QList<int> luma(const QImage &image)
+{
+    const QImage rgb = image.convertToFormat(QImage::Format_RGB32);
+    QList<int> values;
+    values.reserve(rgb.width() * rgb.height());
+    for (int y = 0; y < rgb.height(); ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(rgb.constScanLine(y));
+        for (int x = 0; x < rgb.width(); ++x) {
+            values.append(qGray(line[x]));
+        }
+    }
+    return values;
+}
+
+// The mean SSIM of the 8x8 blocks of the luma of @p a and @p b, from 1
+// for the same image down towards 0
+double similarity(const QImage &a, QImage b)
+{
+    if (b.size() != a.size()) {
+        b = b.scaled(a.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    const QList<int> x = luma(a);
+    const QList<int> y = luma(b);
+    const int width = a.width();
+    const double c1 = (0.01 * 255) * (0.01 * 255);
+    const double c2 = (0.03 * 255) * (0.03 * 255);
+
+    double total = 0;
+    int blocks = 0;
+    for (int top = 0; top + 8 <= a.height(); top += 8) {
+        for (int left = 0; left + 8 <= width; left += 8) {
+            double sumX = 0, sumY = 0, sumXX = 0, sumYY = 0, sumXY = 0;
+            for (int row = top; row < top + 8; ++row) {
+                for (int column = left; column < left + 8; ++column) {
+                    const double p = x.at(row * width + column);
+                    const double q = y.at(row * width + column);
+                    sumX += p;
+                    sumY += q;
+                    sumXX += p * p;
+                    sumYY += q * q;
+                    sumXY += p * q;
+                }
+            }
+            const double meanX = sumX / 64, meanY = sumY / 64;
+            const double varianceX = sumXX / 64 - meanX * meanX;
+            const double varianceY = sumYY / 64 - meanY * meanY;
+            const double covariance = sumXY / 64 - meanX * meanY;
+            total += ((2 * meanX * meanY + c1) * (2 * covariance + c2)) / ((meanX * meanX + meanY * meanY + c1) * (varianceX + varianceY + c2));
+            ++blocks;
+        }
+    }
+    return blocks ? total / blocks : 0;
+}
+}
+
+void GsDraftBench::initTestCase()
+{
+    if (QStandardPaths::findExecutable(QStringLiteral("gs")).isEmpty()) {
+        QSKIP("gs not found");
+    }
+    QVERIFY(m_dir.isValid());
+
+    m_fileName = m_dir.filePath(QStringLiteral("brochure.pdf"));
+    QFile file(m_fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.write(Corpus::brochure()) > 0);
+}
+
+void GsDraftBench::render_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<bool>("draft");
+
+    // Full first, which the draft of the same size is compared to
+    for (int size : {128, 256}) {
+        QTest::addRow("brochure-%d/full", size) << size << false;
+        QTest::addRow("brochure-%d/draft", size) << size << true;
+    }
+}
+
+void GsDraftBench::render()
+{
+    QFETCH(int, size);
+    QFETCH(bool, draft);
+
+    const QByteArray name = QFile::encodeName(m_fileName);
+    const GSDraftProfile profile;
+    qint64 nanoseconds = 0;
+    int runs = 0;
+    QByteArray output;
+
+    QBENCHMARK {
+        QElapsedTimer timer;
+        timer.start();
+
+        GSProcess gs;
+        gs.setArguments(pdfArguments(name, size));
+        if (draft) {
+            GSLimits limits;
+            limits.maxBitmap = profile.maxBitmap;
+            gs.setLimits(limits);
+            gs.setOptions(GSDraftProfile::arguments());
+        }
+        output.clear();
+        gs.run(&output);
+
+        nanoseconds += timer.nsecsElapsed();
+        ++runs;
+    }
+
+    QImage image;
+    QVERIFY(image.loadFromData(output, "PNG"));
+    const double milliseconds = runs ? nanoseconds / 1e6 / runs : 0.0;
+    const QString tag = QLatin1String(QTest::currentDataTag());
+
+    if (!draft) {
+        m_fullTimes.insert(size, milliseconds);
+        m_fullImages.insert(size, image);
+        qInfo().noquote() << QStringLiteral("%1: %2 ms per document").arg(tag).arg(milliseconds, 0, 'f', 2);
+        return;
+    }
+
+    QVERIFY(m_fullImages.contains(size));
+    const double full = m_fullTimes.value(size);
+    qInfo().noquote() << QStringLiteral("%1: %2 ms per document, %3x faster, SSIM %4")
+                             .arg(tag)
+                             .arg(milliseconds, 0, 'f', 2)
+                             .arg(milliseconds > 0 ? full / milliseconds : 0.0, 0, 'f', 2)
+                             .arg(similarity(m_fullImages.value(size), image), 0, 'f', 4);
+}
+
+QTEST_MAIN(GsDraftBench)
+
+#include "gsdraftbench.moc"
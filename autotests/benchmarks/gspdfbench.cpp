@@ -0,0 +1,138 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "corpus.h"
+#include "dscparse_adapter.h"
+#include "gsprocess.h"
+
+/**
+ * The PDF path of the ps thumbnailer against the one PDF files took
+ * before they had their own: a DSC scan through the whole file, which
+ * finds nothing, then gs reading our PostScript prolog from standard
+ * input before the file. Both render the first page of generated PDF
+ * files of growing page counts. gs must be in PATH.
+ */
+class GsPdfBench : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void render_data();
+    void render();
+
+private:
+    QTemporaryDir m_dir;
+};
+
+namespace
+{
+// As GSCreator builds them
+const char psprolog[] =
+    "%!PS-Adobe-3.0\n"
+    "/.showpage.orig /showpage load def\n"
+    "/.showpage.firstonly {\n"
+    "    .showpage.orig\n"
+    "    quit\n"
+    "} def\n"
+    "/showpage { .showpage.firstonly } def\n";
+
+QList<QByteArray> legacyArguments(const QByteArray &fileName)
+{
+    return {"gs", "-sDEVICE=png16m", "-sOutputFile=-", "-dSAFER", "-dPARANOIDSAFER", "-dNOPAUSE", "-dFirstPage=1", "-dLastPage=1",
+            "-q", "-", fileName, "-c", "showpage", "-c", "quit"};
+}
+
+QList<QByteArray> pdfArguments(const QByteArray &fileName)
+{
+    return {"gs", "-sDEVICE=png16m", "-sOutputFile=-", "-dSAFER", "-dBATCH", "-dNOPAUSE", "-dFirstPage=1", "-dLastPage=1", "-dPrinted=false", "-q", fileName};
+}
+
+// What scanning a PDF file for DSC comments used to cost: as there
+// are none, the header never ends and the whole file is read.
+void scanComments(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    KDSC dsc;
+    char buffer[4096];
+    qint64 count;
+    while ((count = file.read(buffer, sizeof(buffer))) > 0) {
+        dsc.scanData(buffer, count);
+    }
+}
+}
+
+void GsPdfBench::initTestCase()
+{
+    if (QStandardPaths::findExecutable(QStringLiteral("gs")).isEmpty()) {
+        QSKIP("gs not found");
+    }
+    QVERIFY(m_dir.isValid());
+}
+
+void GsPdfBench::render_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<bool>("legacy");
+
+    for (int pages : {1, 50, 500}) {
+        const QString fileName = m_dir.filePath(QStringLiteral("pdf-%1.pdf").arg(pages));
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QVERIFY(file.write(Corpus::pdf(pages)) > 0);
+        file.close();
+
+        QTest::addRow("pdf-%d/legacy", pages) << fileName << true;
+        QTest::addRow("pdf-%d/pdf", pages) << fileName << false;
+    }
+}
+
+void GsPdfBench::render()
+{
+    QFETCH(QString, fileName);
+    QFETCH(bool, legacy);
+
+    const QByteArray name = QFile::encodeName(fileName);
+    qint64 nanoseconds = 0;
+    int runs = 0;
+    bool rendered = true;
+
+    QBENCHMARK {
+        QElapsedTimer timer;
+        timer.start();
+
+        GSProcess gs;
+        if (legacy) {
+            scanComments(fileName);
+            gs.setArguments(legacyArguments(name));
+            gs.setInput(psprolog);
+        } else {
+            gs.setArguments(pdfArguments(name));
+        }
+        QByteArray output;
+        gs.run(&output);
+        rendered = rendered && output.contains("\x89PNG");
+
+        nanoseconds += timer.nsecsElapsed();
+        ++runs;
+    }
+
+    QVERIFY(rendered);
+    qInfo().noquote() << QStringLiteral("%1: %2 ms per document").arg(QLatin1String(QTest::currentDataTag())).arg(runs ? nanoseconds / 1e6 / runs : 0.0, 0, 'f', 2);
+}
+
+QTEST_MAIN(GsPdfBench)
+
+#include "gspdfbench.moc"
@@ -0,0 +1,179 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gsprocess.h"
+
+/**
+ * What starting gs costs the ps thumbnailer against the memory of the
+ * process it runs in, which is a kio worker holding all of Qt and
+ * possibly large images. The benchmark grows itself by 0, 1 and 4 GiB
+ * of touched pages, then times GSProcess from start to exit of
+ * "gs -v", next to fork() and exec() of the same, whose cost grows with
+ * the page tables it copies. gs must be in PATH.
+ */
+class GsSpawnBench : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void spawn_data();
+    void spawn();
+
+private:
+    bool balloon(qint64 size);
+
+    void *m_balloon = MAP_FAILED;
+    qint64 m_balloonSize = 0;
+};
+
+namespace
+{
+const QList<QByteArray> version = {"gs", "-v"};
+
+// No limits, which would put a shell between us and gs
+GSLimits noLimits()
+{
+    GSLimits limits;
+    limits.cpu = 0;
+    limits.memory = 0;
+    limits.fileSize = 0;
+    limits.openFiles = 0;
+    limits.maxBitmap = 0;
+    return limits;
+}
+
+bool runGSProcess()
+{
+    GSProcess gs;
+    gs.setArguments(version);
+    gs.setLimits(noLimits());
+    QByteArray output;
+    gs.run(&output);
+    return gs.status() == GSProcess::Succeeded && !output.isEmpty();
+}
+
+// As the launcher did before posix_spawn()
+bool runFork()
+{
+    const pid_t pid = fork();
+    if (pid == -1) {
+        return false;
+    }
+    if (pid == 0) {
+        const int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        execlp("gs", "gs", "-v", static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    int status;
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+}
+
+void GsSpawnBench::initTestCase()
+{
+    if (QStandardPaths::findExecutable(QStringLiteral("gs")).isEmpty()) {
+        QSKIP("gs not found");
+    }
+}
+
+void GsSpawnBench::cleanupTestCase()
+{
+    balloon(0);
+}
+
+// Resizes the memory the benchmark holds to @p size bytes, each page of
+// it written to, so that it is resident and has page table entries
+bool GsSpawnBench::balloon(qint64 size)
+{
+    if (size == m_balloonSize) {
+        return true;
+    }
+    if (m_balloon != MAP_FAILED) {
+        munmap(m_balloon, m_balloonSize);
+        m_balloon = MAP_FAILED;
+        m_balloonSize = 0;
+    }
+    if (size == 0) {
+        return true;
+    }
+
+    // Not more than half of the memory of the machine
+    const qint64 pageSize = sysconf(_SC_PAGESIZE);
+    if (size > qint64(sysconf(_SC_PHYS_PAGES)) * pageSize / 2) {
+        return false;
+    }
+    m_balloon = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m_balloon == MAP_FAILED) {
+        return false;
+    }
+    m_balloonSize = size;
+    char *pages = static_cast<char *>(m_balloon);
+    for (qint64 offset = 0; offset < size; offset += pageSize) {
+        pages[offset] = 1;
+    }
+    return true;
+}
+
+void GsSpawnBench::spawn_data()
+{
+    QTest::addColumn<int>("gibibytes");
+    QTest::addColumn<bool>("forked");
+
+    // Growing only, so that each size is touched once
+    for (int gibibytes : {0, 1, 4}) {
+        QTest::addRow("rss-%dG/gsprocess", gibibytes) << gibibytes << false;
+        QTest::addRow("rss-%dG/fork", gibibytes) << gibibytes << true;
+    }
+}
+
+void GsSpawnBench::spawn()
+{
+    QFETCH(int, gibibytes);
+    QFETCH(bool, forked);
+
+    if (!balloon(qint64(gibibytes) << 30)) {
+        QSKIP("not enough memory");
+    }
+
+    qint64 nanoseconds = 0;
+    int runs = 0;
+    bool succeeded = true;
+
+    QBENCHMARK {
+        QElapsedTimer timer;
+        timer.start();
+
+        succeeded = (forked ? runFork() : runGSProcess()) && succeeded;
+
+        nanoseconds += timer.nsecsElapsed();
+        ++runs;
+    }
+
+    QVERIFY(succeeded);
+    qInfo().noquote() << QStringLiteral("%1: %2 ms from start to exit").arg(QLatin1String(QTest::currentDataTag())).arg(runs ? nanoseconds / 1e6 / runs : 0.0, 0, 'f', 3);
+}
+
+QTEST_GUILESS_MAIN(GsSpawnBench)
+
+#include "gsspawnbench.moc"
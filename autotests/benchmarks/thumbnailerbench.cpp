@@ -0,0 +1,207 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMimeDatabase>
+#include <QSize>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUrl>
+
+#include <KIO/ThumbnailCreator>
+#include <KPluginFactory>
+#include <KPluginMetaData>
+
+#include <algorithm>
+#include <memory>
+
+#include "allocations.h"
+#include "corpus.h"
+
+/**
+ * Latency, memory and allocations of each thumbnailer plugin of the
+ * build, over the generated corpus at the three smaller thumbnail
+ * sizes. Documents found in THUMBNAILER_BENCH_CORPUS, a directory, are
+ * added to the corpus, e.g. RAW files, for which there is no generator.
+ *
+ * Each document and size is run cold, by a new creator over an empty
+ * cache directory each time, and warm, by one creator which has made
+ * the thumbnail before, so that its caches answer. The files
+ * themselves are in the page cache either way.
+ *
+ * QBENCHMARK reports the mean; the percentiles, peak RSS and
+ * allocations per document are printed for each row.
+ */
+class ThumbnailerBench : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void create_data();
+    void create();
+
+private:
+    const KPluginMetaData *pluginFor(const QString &mimeType) const;
+
+    QTemporaryDir m_corpusDir;
+    QList<Corpus::Sample> m_corpus;
+    QList<KPluginMetaData> m_plugins;
+};
+
+namespace
+{
+qint64 percentile(QList<qint64> samples, int percent)
+{
+    if (samples.isEmpty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    const qsizetype rank = (samples.size() * percent + 99) / 100;
+    return samples.at(qBound<qsizetype>(0, rank - 1, samples.size() - 1));
+}
+
+std::unique_ptr<KIO::ThumbnailCreator> newCreator(const KPluginMetaData &metaData)
+{
+    auto result = KPluginFactory::instantiatePlugin<KIO::ThumbnailCreator>(metaData);
+    if (!result) {
+        qWarning() << "Cannot load" << metaData.fileName() << result.errorText;
+    }
+    return std::unique_ptr<KIO::ThumbnailCreator>(result.plugin);
+}
+
+// Where the plugins keep what they learn of documents. With test mode
+// on, Qt ignores XDG_CACHE_HOME and uses a directory of its own, which
+// is emptied instead.
+void clearCache()
+{
+    QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/kdegraphics-thumbnailers")).removeRecursively();
+}
+}
+
+void ThumbnailerBench::initTestCase()
+{
+    // Keep the caches of the plugins away from the user's
+    QStandardPaths::setTestModeEnabled(true);
+
+    const QStringList pluginFiles = QStringLiteral(THUMBNAILER_PLUGINS).split(QLatin1Char(':'), Qt::SkipEmptyParts);
+    for (const QString &file : pluginFiles) {
+        const KPluginMetaData metaData(file);
+        if (newCreator(metaData)) {
+            m_plugins.append(metaData);
+        }
+    }
+    QVERIFY(!m_plugins.isEmpty());
+
+    QVERIFY(m_corpusDir.isValid());
+    m_corpus = Corpus::generate(m_corpusDir.path());
+
+    const QString extra = qEnvironmentVariable("THUMBNAILER_BENCH_CORPUS");
+    if (!extra.isEmpty()) {
+        const QMimeDatabase mimeDb;
+        const QDir dir(extra);
+        for (const QFileInfo &info : dir.entryInfoList(QDir::Files, QDir::Name)) {
+            m_corpus.append({info.fileName(), info.absoluteFilePath(), mimeDb.mimeTypeForFile(info).name()});
+        }
+    }
+}
+
+// Every row starts from an empty cache
+void ThumbnailerBench::init()
+{
+    clearCache();
+}
+
+const KPluginMetaData *ThumbnailerBench::pluginFor(const QString &mimeType) const
+{
+    const QMimeDatabase mimeDb;
+    const QMimeType type = mimeDb.mimeTypeForName(mimeType);
+    for (const KPluginMetaData &plugin : m_plugins) {
+        for (const QString &supported : plugin.mimeTypes()) {
+            if (type.inherits(supported)) {
+                return &plugin;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void ThumbnailerBench::create_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<QString>("mimeType");
+    QTest::addColumn<int>("size");
+    QTest::addColumn<bool>("cold");
+
+    for (const Corpus::Sample &sample : std::as_const(m_corpus)) {
+        if (!pluginFor(sample.mimeType)) {
+            continue;
+        }
+        for (int size : {128, 256, 512}) {
+            QTest::addRow("%s@%d/cold", qPrintable(sample.name), size) << sample.fileName << sample.mimeType << size << true;
+            QTest::addRow("%s@%d/warm", qPrintable(sample.name), size) << sample.fileName << sample.mimeType << size << false;
+        }
+    }
+}
+
+void ThumbnailerBench::create()
+{
+    QFETCH(QString, fileName);
+    QFETCH(QString, mimeType);
+    QFETCH(int, size);
+    QFETCH(bool, cold);
+
+    const KPluginMetaData *plugin = pluginFor(mimeType);
+    QVERIFY(plugin);
+    const KIO::ThumbnailRequest request(QUrl::fromLocalFile(fileName), QSize(size, size), mimeType, 1.0, 0.0f);
+
+    // Warm runs make the thumbnail once before they are timed
+    std::unique_ptr<KIO::ThumbnailCreator> creator = newCreator(*plugin);
+    QVERIFY(creator);
+    if (!cold) {
+        creator->create(request);
+    }
+
+    const bool peakReset = Allocations::resetPeakResidentSize();
+    QList<qint64> latencies;
+    quint64 allocations = 0;
+    bool valid = false;
+
+    QBENCHMARK {
+        if (cold) {
+            clearCache();
+            creator = newCreator(*plugin);
+        }
+        const quint64 allocationsBefore = Allocations::count();
+        QElapsedTimer timer;
+        timer.start();
+        const KIO::ThumbnailResult result = creator->create(request);
+        latencies.append(timer.nsecsElapsed());
+        allocations += Allocations::count() - allocationsBefore;
+        valid = result.isValid();
+    }
+
+    const qint64 p50 = percentile(latencies, 50);
+    const qint64 p95 = percentile(latencies, 95);
+    qInfo().noquote() << QStringLiteral("%1: %2 runs, p50 %3 ms, p95 %4 ms, peak RSS %5 KiB%6, children %7 KiB, %8 allocations per document%9")
+                             .arg(QLatin1String(QTest::currentDataTag()))
+                             .arg(latencies.size())
+                             .arg(p50 / 1e6, 0, 'f', 2)
+                             .arg(p95 / 1e6, 0, 'f', 2)
+                             .arg(Allocations::peakResidentSize())
+                             .arg(peakReset ? QString() : QStringLiteral(" (whole run)"))
+                             .arg(Allocations::peakChildResidentSize())
+                             .arg(Allocations::isCounting() && !latencies.isEmpty() ? QString::number(allocations / latencies.size()) : QStringLiteral("n/a"))
+                             .arg(valid ? QString() : QStringLiteral(", no thumbnail"));
+}
+
+QTEST_MAIN(ThumbnailerBench)
+
+#include "thumbnailerbench.moc"
@@ -0,0 +1,287 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "gsprocess.h"
+
+/**
+ * The caps GSProcess puts on gs, each against a PostScript program
+ * which would go over it. Programs that end anyway are also run without
+ * the cap, to tell the cap from any other failure; the others would run
+ * until the time limit, which is far longer than the tests allow. gs
+ * must be in PATH.
+ */
+class GSProcessTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void memoryBomb();
+    void cpuLoop();
+    void bigOutput();
+    void openFiles();
+    void bandedPage();
+    void cgroup();
+    void missingCgroup();
+    void timeout();
+    void ignoredTerminate();
+    void missingProgram();
+
+private:
+    QTemporaryDir m_dir;
+};
+
+namespace
+{
+// Far above what any of the programs below takes with its cap
+const int wallTime = 60 * 1000;
+
+// No limits but the time limit
+GSLimits noLimits()
+{
+    GSLimits limits;
+    limits.timeout = wallTime;
+    limits.cpu = 0;
+    limits.memory = 0;
+    limits.fileSize = 0;
+    limits.openFiles = 0;
+    limits.maxBitmap = 0;
+    return limits;
+}
+
+QList<QByteArray> arguments(const QByteArray &outputFile = "-", const QByteArray &device = "png16m")
+{
+    return {"gs", "-sDEVICE=" + device, "-sOutputFile=" + outputFile, "-dSAFER", "-dBATCH", "-dNOPAUSE", "-q", "-"};
+}
+
+struct Run {
+    GSProcess::Status status;
+    QByteArray output;
+    qint64 elapsed;
+};
+
+Run run(const QByteArray &program, const GSLimits &limits, const QList<QByteArray> &command = arguments())
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    GSProcess gs;
+    gs.setArguments(command);
+    gs.setInput(program);
+    gs.setLimits(limits);
+    Run result;
+    gs.run(&result.output);
+    result.status = gs.status();
+    result.elapsed = timer.elapsed();
+    return result;
+}
+
+bool hasImage(const QByteArray &output)
+{
+    return output.contains("\x89PNG");
+}
+
+// Runs @p body, then prints "done", or the name of the error it stopped
+// with, on the standard output, which the null device leaves alone
+QByteArray reporting(const QByteArray &body)
+{
+    return "{ " + body + " } stopped { $error /errorname get == } { (done) = } ifelse\n";
+}
+
+QList<QByteArray> nullArguments()
+{
+    return arguments("/dev/null", "nullpage");
+}
+}
+
+void GSProcessTest::initTestCase()
+{
+#if !defined(Q_OS_LINUX)
+    QSKIP("resource limits are only applied on Linux");
+#endif
+    if (QStandardPaths::findExecutable(QStringLiteral("gs")).isEmpty()) {
+        QSKIP("gs not found");
+    }
+    QVERIFY(m_dir.isValid());
+
+    // The programs below are fine, it is their size that is hostile
+    const Run page = run("showpage\n", noLimits());
+    QCOMPARE(page.status, GSProcess::Succeeded);
+    QVERIFY(hasImage(page.output));
+}
+
+// 512 strings of 1 MiB, all kept. gs reports a VMerror at the cap and
+// exits with 1, which is not a failure of the run, so the program tells
+// how it ended. Without the cap, it gets through.
+void GSProcessTest::memoryBomb()
+{
+    const QByteArray program = reporting("[ 0 1 511 { pop 1048576 string } for ] pop");
+
+    const Run uncapped = run(program, noLimits(), nullArguments());
+    QCOMPARE(uncapped.status, GSProcess::Succeeded);
+    QVERIFY(uncapped.output.contains("done"));
+
+    GSLimits limits = noLimits();
+    limits.memory = qint64(384) << 20;
+    const Run result = run(program, limits, nullArguments());
+    QCOMPARE(result.status, GSProcess::Succeeded);
+    QVERIFY(result.output.contains("VMerror"));
+    QVERIFY(result.elapsed < wallTime / 2);
+}
+
+// SIGXCPU at the soft limit
+void GSProcessTest::cpuLoop()
+{
+    GSLimits limits = noLimits();
+    limits.cpu = 1;
+
+    const Run result = run("{ } loop showpage\n", limits);
+    QVERIFY(result.status == GSProcess::Crashed || result.status == GSProcess::Failed);
+    QVERIFY(!hasImage(result.output));
+    QVERIFY(result.elapsed < wallTime / 2);
+}
+
+// A 48 MB raw page written to a file, SIGXFSZ at 1 MiB
+void GSProcessTest::bigOutput()
+{
+    GSLimits limits = noLimits();
+    limits.fileSize = 1024 * 1024;
+
+    const QString path = m_dir.filePath(QStringLiteral("page.ppm"));
+    QList<QByteArray> command = arguments(QFile::encodeName(path), "ppmraw");
+    command.insert(1, "-g4000x4000");
+
+    const Run result = run("showpage\n", limits, command);
+    QVERIFY(result.status == GSProcess::Crashed || result.status == GSProcess::Failed);
+    QVERIFY(QFileInfo(path).size() <= limits.fileSize);
+}
+
+// The same file opened 500 times and never closed. Under the cap, an
+// open fails, and gs stops with an error.
+void GSProcessTest::openFiles()
+{
+    const QString path = m_dir.filePath(QStringLiteral("open.txt"));
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+    const QByteArray name = QFile::encodeName(path);
+    QList<QByteArray> command = nullArguments();
+    command.insert(1, "--permit-file-read=" + name);
+    const QByteArray program = reporting("[ 0 1 499 { pop (" + name + ") (r) file } for ] pop");
+
+    const Run uncapped = run(program, noLimits(), command);
+    QCOMPARE(uncapped.status, GSProcess::Succeeded);
+    QVERIFY(uncapped.output.contains("done"));
+
+    GSLimits limits = noLimits();
+    limits.openFiles = 64;
+    const Run result = run(program, limits, command);
+    QCOMPARE(result.status, GSProcess::Succeeded);
+    QVERIFY(!result.output.contains("done"));
+    QVERIFY(result.output.contains("/"));
+}
+
+// A 192 MB raw page under a memory cap of 160 MiB, which gs only
+// renders if MaxBitmap makes it band the page
+void GSProcessTest::bandedPage()
+{
+    QList<QByteArray> command = arguments("/dev/null", "ppmraw");
+    command.insert(1, "-g8000x8000");
+    const QByteArray program = reporting("showpage");
+
+    GSLimits limits = noLimits();
+    limits.memory = qint64(160) << 20;
+    limits.maxBitmap = qint64(2) << 30;
+    const Run whole = run(program, limits, command);
+    QVERIFY(!whole.output.contains("done"));
+
+    limits.maxBitmap = qint64(8) << 20;
+    limits.bufferSpace = qint64(4) << 20;
+    const Run banded = run(program, limits, command);
+    QCOMPARE(banded.status, GSProcess::Succeeded);
+    QVERIFY(banded.output.contains("done"));
+}
+
+// GSTHUMBNAIL_TEST_CGROUP names a delegated cgroup v2 directory with
+// the memory controller enabled for its children
+void GSProcessTest::cgroup()
+{
+    const QString parent = qEnvironmentVariable("GSTHUMBNAIL_TEST_CGROUP");
+    if (parent.isEmpty() || !QFileInfo(parent + QLatin1String("/cgroup.subtree_control")).isWritable()) {
+        QSKIP("no delegated cgroup, set GSTHUMBNAIL_TEST_CGROUP");
+    }
+
+    GSLimits limits = noLimits();
+    limits.cgroup = parent;
+    limits.memory = qint64(384) << 20;
+
+    const Run page = run("showpage\n", limits);
+    QCOMPARE(page.status, GSProcess::Succeeded);
+    QVERIFY(hasImage(page.output));
+
+    // Either cap may stop it first, memory.max by killing gs
+    const Run bomb = run(reporting("[ 0 1 511 { pop 1048576 string } for ] pop"), limits, nullArguments());
+    QVERIFY(bomb.status == GSProcess::Crashed || bomb.output.contains("VMerror"));
+
+    // The leaves are gone once their runs have ended
+    QVERIFY(QDir(parent).entryList({QStringLiteral("gsthumbnail-*")}, QDir::Dirs).isEmpty());
+}
+
+// A cgroup whose leaf cannot be made is not run without one
+void GSProcessTest::missingCgroup()
+{
+    GSLimits limits = noLimits();
+    limits.cgroup = m_dir.filePath(QStringLiteral("no-such-cgroup"));
+
+    const Run result = run("showpage\n", limits);
+    QCOMPARE(result.status, GSProcess::NotStarted);
+}
+
+void GSProcessTest::timeout()
+{
+    GSLimits limits = noLimits();
+    limits.timeout = 1000;
+
+    const Run result = run("{ } loop showpage\n", limits);
+    QCOMPARE(result.status, GSProcess::TimedOut);
+    QVERIFY(result.elapsed < wallTime / 2);
+}
+
+// A child that ignores SIGTERM after the timeout is killed after the
+// grace period
+void GSProcessTest::ignoredTerminate()
+{
+    GSLimits limits = noLimits();
+    limits.timeout = 500;
+
+    const Run result = run(QByteArray(), limits, {"/bin/sh", "-c", "trap '' TERM; while :; do sleep 1; done"});
+    QCOMPARE(result.status, GSProcess::TimedOut);
+    QVERIFY(result.elapsed < 10 * 1000);
+}
+
+// Neither gs missing nor its limits are held against a document
+void GSProcessTest::missingProgram()
+{
+    GSLimits limits = noLimits();
+    limits.cpu = 20;
+
+    QList<QByteArray> command = arguments();
+    command[0] = "gsthumbnail-no-such-program";
+    const Run result = run("showpage\n", limits, command);
+    QCOMPARE(result.status, GSProcess::NotStarted);
+}
+
+QTEST_GUILESS_MAIN(GSProcessTest)
+
+#include "gsprocesstest.moc"
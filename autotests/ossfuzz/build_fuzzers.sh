@@ -86,7 +86,8 @@ ninja -C build -j$(nproc)
 
 EXTENSIONS="blenderthumbnail_fuzzer blend
             mobithumbnail_fuzzer mobi
-            gsthumbnail_fuzzer dvi ps pdf eps
+            gsthumbnail_fuzzer dvi ps pdf eps ai
+            dscparse_fuzzer ps eps
             rawthumbnail_fuzzer cr2 cr3 nef nrw arw srf orf rw2 raf dng pef srw kdc erf"
 
 echo "$EXTENSIONS" | while read fuzzer_name extensions; do
@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+// Drives the DSC parser of the ps thumbnailer directly, without
+// Ghostscript, feeding it the input in chunks of varying size.
+//
+// The last two bytes of the input are not part of the document: the
+// first seeds the chunk sizes, the second selects what is exercised,
+// like GSCreator stopping after the header and reading the trailer.
+// Taking them from the end keeps plain PostScript files useful as seeds.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "dscparse_adapter.h"
+
+namespace
+{
+class HeaderEndHandler : public KDSCCommentHandler
+{
+public:
+    bool endComments = false;
+
+    void comment(Name name) override
+    {
+        if (name == EndPreview || name == BeginProlog || name == Page) {
+            endComments = true;
+        }
+    }
+};
+
+// Between 1 and 4096 bytes
+unsigned int nextChunk(uint32_t *state)
+{
+    *state = *state * 1103515245u + 12345u;
+    return 1 + ((*state >> 16) & 0xfff);
+}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < 2) {
+        return 0;
+    }
+    uint32_t state = data[size - 2];
+    const uint8_t mode = data[size - 1];
+    const bool stopAfterHeader = mode & 1;
+    const bool readTrailer = mode & 2;
+    const bool fixup = mode & 4;
+
+    // The parser takes non-const buffers
+    std::vector<char> document(data, data + size - 2);
+
+    KDSC dsc;
+    HeaderEndHandler handler;
+    dsc.setCommentHandler(&handler);
+
+    size_t offset = 0;
+    while (offset < document.size() && !(stopAfterHeader && handler.endComments)) {
+        const unsigned int count = std::min<size_t>(nextChunk(&state), document.size() - offset);
+        dsc.scanData(document.data() + offset, count);
+        offset += count;
+    }
+
+    if (readTrailer && dsc.atend()) {
+        const size_t start = document.size() > 32768 ? document.size() - 32768 : 0;
+        std::vector<char> trailer(document.begin() + start, document.end());
+        dsc.scanTrailer(trailer.data(), trailer.size(), start);
+    }
+
+    if (fixup) {
+        dsc.fixup();
+    }
+
+    // What GSCreator reads afterwards
+    dsc.bbox();
+    dsc.page_count();
+    dsc.page_pages();
+    dsc.preview();
+    dsc.beginpreview();
+    dsc.endpreview();
+    dsc.beginphotoshop();
+    dsc.endphotoshop();
+    dsc.pjl();
+    dsc.ctrld();
+    dsc.dsc_title();
+
+    return 0;
+}
@@ -0,0 +1,244 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+// Fills the freedesktop.org thumbnail cache for whole directory trees
+// with the thumbnailers of this repository, running them directly in
+// a pool of threads instead of going through KIO one file at a time.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QMimeDatabase>
+#include <QSize>
+#include <QTextStream>
+#include <QThread>
+#include <QUrl>
+
+#include <KIO/ThumbnailCreator>
+#include <KPluginFactory>
+#include <KPluginMetaData>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "thumbnailcache.h"
+#include "workqueue.h"
+
+namespace
+{
+// The plugins built in this repository
+const char *const pluginIds[] = {
+    "gsthumbnail",
+    "rawthumbnail",
+    "blenderthumbnail",
+    "mobithumbnail",
+};
+
+struct Plugin {
+    KPluginMetaData metaData;
+    std::unique_ptr<KIO::ThumbnailCreator> creator;
+};
+
+struct Stats {
+    qint64 files = 0;
+    qint64 failed = 0;
+    qint64 nanoseconds = 0;
+};
+
+// Each worker has its own creators, so that none of them needs to be
+// thread-safe, and its own counters.
+struct Worker {
+    std::vector<Plugin> plugins;
+    QHash<QString, Stats> stats;
+    qint64 upToDate = 0;
+    qint64 unsupported = 0;
+};
+
+QList<KPluginMetaData> findPlugins()
+{
+    return KPluginMetaData::findPlugins(QStringLiteral("kf6/thumbcreator"), [](const KPluginMetaData &metaData) {
+        for (const char *id : pluginIds) {
+            if (metaData.pluginId() == QLatin1String(id)) {
+                return true;
+            }
+        }
+        return false;
+    });
+}
+
+Plugin *pluginFor(Worker &worker, const QMimeType &type)
+{
+    for (Plugin &plugin : worker.plugins) {
+        for (const QString &supported : plugin.metaData.mimeTypes()) {
+            if (type.inherits(supported)) {
+                return &plugin;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void work(Worker &worker, int index, WorkQueue &queue, const ThumbnailCache &cache, bool force)
+{
+    const QMimeDatabase mimeDb;
+    QString path;
+    while (queue.take(index, &path)) {
+        const QFileInfo file(path);
+        if (!force && cache.isUpToDate(file)) {
+            ++worker.upToDate;
+            continue;
+        }
+
+        const QMimeType type = mimeDb.mimeTypeForFile(file);
+        Plugin *plugin = pluginFor(worker, type);
+        if (!plugin) {
+            ++worker.unsupported;
+            continue;
+        }
+
+        const KIO::ThumbnailRequest request(QUrl::fromLocalFile(file.absoluteFilePath()),
+                                            QSize(cache.pixels(), cache.pixels()),
+                                            type.name(),
+                                            1.0,
+                                            0.0f);
+        QElapsedTimer timer;
+        timer.start();
+        const KIO::ThumbnailResult result = plugin->creator->create(request);
+        const qint64 elapsed = timer.nsecsElapsed();
+
+        Stats &stats = worker.stats[plugin->metaData.pluginId()];
+        ++stats.files;
+        stats.nanoseconds += elapsed;
+        if (!result.isValid() || !cache.store(file, type.name(), result.image())) {
+            ++stats.failed;
+        }
+    }
+}
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("kdegraphics-thumbnail-batch"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Create thumbnails for all files below the given paths."));
+    parser.addHelpOption();
+    const QCommandLineOption jobsOption({QStringLiteral("j"), QStringLiteral("jobs")},
+                                        QStringLiteral("Number of threads, by default one per CPU."),
+                                        QStringLiteral("count"));
+    const QCommandLineOption sizeOption({QStringLiteral("s"), QStringLiteral("size")},
+                                        QStringLiteral("Thumbnail size: normal, large, x-large or xx-large."),
+                                        QStringLiteral("size"),
+                                        QStringLiteral("normal"));
+    const QCommandLineOption forceOption({QStringLiteral("f"), QStringLiteral("force")},
+                                         QStringLiteral("Also replace thumbnails that are up to date."));
+    parser.addOption(jobsOption);
+    parser.addOption(sizeOption);
+    parser.addOption(forceOption);
+    parser.addPositionalArgument(QStringLiteral("paths"), QStringLiteral("Files and directories to create thumbnails for."), QStringLiteral("paths..."));
+    parser.process(app);
+
+    QTextStream err(stderr);
+    QTextStream out(stdout);
+
+    const QStringList paths = parser.positionalArguments();
+    if (paths.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    const ThumbnailCache cache(parser.value(sizeOption));
+    if (!cache.isValid()) {
+        err << "Unknown thumbnail size " << parser.value(sizeOption) << Qt::endl;
+        return 1;
+    }
+
+    int jobs = QThread::idealThreadCount();
+    if (parser.isSet(jobsOption)) {
+        jobs = parser.value(jobsOption).toInt();
+        if (jobs < 1) {
+            err << "Invalid number of jobs " << parser.value(jobsOption) << Qt::endl;
+            return 1;
+        }
+    }
+
+    const QList<KPluginMetaData> found = findPlugins();
+    if (found.isEmpty()) {
+        err << "No thumbnailer plugins found" << Qt::endl;
+        return 1;
+    }
+
+    std::vector<Worker> workers(jobs);
+    for (Worker &worker : workers) {
+        for (const KPluginMetaData &metaData : found) {
+            auto result = KPluginFactory::instantiatePlugin<KIO::ThumbnailCreator>(metaData);
+            if (result) {
+                worker.plugins.push_back({metaData, std::unique_ptr<KIO::ThumbnailCreator>(result.plugin)});
+            }
+        }
+    }
+
+    QElapsedTimer wallClock;
+    wallClock.start();
+
+    WorkQueue queue(jobs);
+    const bool force = parser.isSet(forceOption);
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int i = 0; i < jobs; ++i) {
+        threads.emplace_back(QThread::create(work, std::ref(workers[i]), i, std::ref(queue), std::cref(cache), force));
+        threads.back()->start();
+    }
+
+    // Walk while the workers already run
+    for (const QString &path : paths) {
+        const QFileInfo info(path);
+        if (info.isFile()) {
+            queue.push(info.absoluteFilePath());
+            continue;
+        }
+        QDirIterator it(path, QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            queue.push(it.next());
+        }
+    }
+    queue.close();
+
+    for (const std::unique_ptr<QThread> &thread : threads) {
+        thread->wait();
+    }
+    const double seconds = wallClock.nsecsElapsed() / 1e9;
+
+    QHash<QString, Stats> total;
+    qint64 files = 0;
+    qint64 upToDate = 0;
+    qint64 unsupported = 0;
+    for (const Worker &worker : workers) {
+        for (auto it = worker.stats.cbegin(); it != worker.stats.cend(); ++it) {
+            Stats &stats = total[it.key()];
+            stats.files += it->files;
+            stats.failed += it->failed;
+            stats.nanoseconds += it->nanoseconds;
+            files += it->files;
+        }
+        upToDate += worker.upToDate;
+        unsupported += worker.unsupported;
+    }
+
+    // A plugin's files/s is per thread busy running it
+    for (auto it = total.cbegin(); it != total.cend(); ++it) {
+        out << it.key() << ": " << it->files << " files, " << it->failed << " failed, "
+            << QString::number(it->nanoseconds ? it->files * 1e9 / it->nanoseconds : 0.0, 'f', 1) << " files/s" << Qt::endl;
+    }
+    out << "total: " << files << " files in " << QString::number(seconds, 'f', 1) << " s with " << jobs << " threads, "
+        << QString::number(seconds > 0 ? files / seconds : 0.0, 'f', 1) << " files/s; " << upToDate << " up to date, " << unsupported << " unsupported"
+        << Qt::endl;
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "thumbnailcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+
+namespace
+{
+struct Size {
+    const char *name;
+    int pixels;
+};
+
+const Size sizes[] = {
+    {"normal", 128},
+    {"large", 256},
+    {"x-large", 512},
+    {"xx-large", 1024},
+};
+
+QString fileUri(const QFileInfo &file)
+{
+    return QUrl::fromLocalFile(file.absoluteFilePath()).toString(QUrl::FullyEncoded);
+}
+
+QString modificationTime(const QFileInfo &file)
+{
+    return QString::number(file.lastModified().toSecsSinceEpoch());
+}
+}
+
+ThumbnailCache::ThumbnailCache(const QString &size)
+    : m_pixels(0)
+{
+    for (const Size &known : sizes) {
+        if (size == QLatin1String(known.name)) {
+            m_pixels = known.pixels;
+            m_directory = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/thumbnails/") + size;
+        }
+    }
+}
+
+bool ThumbnailCache::isValid() const
+{
+    return m_pixels != 0;
+}
+
+int ThumbnailCache::pixels() const
+{
+    return m_pixels;
+}
+
+QString ThumbnailCache::thumbnailPath(const QFileInfo &file) const
+{
+    const QByteArray hash = QCryptographicHash::hash(fileUri(file).toUtf8(), QCryptographicHash::Md5).toHex();
+    return m_directory + QLatin1Char('/') + QString::fromLatin1(hash) + QLatin1String(".png");
+}
+
+bool ThumbnailCache::isUpToDate(const QFileInfo &file) const
+{
+    QImageReader reader(thumbnailPath(file));
+    return reader.canRead() && reader.text(QStringLiteral("Thumb::MTime")) == modificationTime(file);
+}
+
+bool ThumbnailCache::store(const QFileInfo &file, const QString &mimeType, const QImage &image) const
+{
+    // The spec wants the directories private to the user
+    if (!QDir().mkpath(m_directory)) {
+        return false;
+    }
+    QFile::setPermissions(m_directory, QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+
+    QImage thumbnail = image;
+    if (thumbnail.width() > m_pixels || thumbnail.height() > m_pixels) {
+        thumbnail = thumbnail.scaled(m_pixels, m_pixels, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    thumbnail.setText(QStringLiteral("Thumb::URI"), fileUri(file));
+    thumbnail.setText(QStringLiteral("Thumb::MTime"), modificationTime(file));
+    thumbnail.setText(QStringLiteral("Thumb::Size"), QString::number(file.size()));
+    thumbnail.setText(QStringLiteral("Thumb::Mimetype"), mimeType);
+    thumbnail.setText(QStringLiteral("Software"), QStringLiteral("kdegraphics-thumbnail-batch"));
+
+    // Written to a temporary file and renamed, so that readers never
+    // see half a thumbnail
+    QSaveFile out(thumbnailPath(file));
+    if (!out.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    return thumbnail.save(&out, "PNG") && out.commit();
+}
@@ -0,0 +1,53 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _THUMBNAILCACHE_H_
+#define _THUMBNAILCACHE_H_
+
+#include <QFileInfo>
+#include <QImage>
+#include <QString>
+
+/**
+ * The thumbnail cache of the freedesktop.org thumbnail specification,
+ * ~/.cache/thumbnails, for one size directory.
+ */
+class ThumbnailCache
+{
+public:
+    /**
+     * @p size is one of the spec's directory names, e.g. "normal".
+     * isValid() is false for an unknown size.
+     */
+    explicit ThumbnailCache(const QString &size);
+
+    bool isValid() const;
+
+    /**
+     * Largest width and height of the thumbnails of this size.
+     */
+    int pixels() const;
+
+    /**
+     * Whether the cache has a thumbnail of @p file made after its last
+     * modification.
+     */
+    bool isUpToDate(const QFileInfo &file) const;
+
+    /**
+     * Scale @p image down to the size if needed and store it for @p file,
+     * with the attributes the spec asks for.
+     */
+    bool store(const QFileInfo &file, const QString &mimeType, const QImage &image) const;
+
+private:
+    QString thumbnailPath(const QFileInfo &file) const;
+
+    QString m_directory;
+    int m_pixels;
+};
+
+#endif
@@ -0,0 +1,83 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "workqueue.h"
+
+#include <QMutexLocker>
+
+WorkQueue::WorkQueue(int workers)
+    : m_next(0)
+    , m_pending(0)
+    , m_closed(false)
+{
+    for (int i = 0; i < workers; ++i) {
+        m_lanes.push_back(std::make_unique<Lane>());
+    }
+}
+
+void WorkQueue::push(const QString &path)
+{
+    Lane &lane = *m_lanes[m_next++ % m_lanes.size()];
+    {
+        QMutexLocker locker(&lane.mutex);
+        lane.items.push_back(path);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    ++m_pending;
+    m_wait.wakeOne();
+}
+
+void WorkQueue::close()
+{
+    QMutexLocker locker(&m_mutex);
+    m_closed = true;
+    m_wait.wakeAll();
+}
+
+bool WorkQueue::take(int worker, QString *path)
+{
+    const int lanes = int(m_lanes.size());
+    for (;;) {
+        bool found = takeFrom(worker, true, path);
+        for (int i = 1; !found && i < lanes; ++i) {
+            found = takeFrom((worker + i) % lanes, false, path);
+        }
+
+        QMutexLocker locker(&m_mutex);
+        if (found) {
+            --m_pending;
+            return true;
+        }
+        // Whatever is pending was pushed after we looked, or is being
+        // taken by another worker right now; look again once there is
+        // something new. A worker may take a file before push() counted
+        // it, so m_pending can briefly drop below zero.
+        while (m_pending <= 0 && !m_closed) {
+            m_wait.wait(&m_mutex);
+        }
+        if (m_pending <= 0 && m_closed) {
+            return false;
+        }
+    }
+}
+
+bool WorkQueue::takeFrom(int lane, bool front, QString *path)
+{
+    Lane &l = *m_lanes[lane];
+    QMutexLocker locker(&l.mutex);
+    if (l.items.empty()) {
+        return false;
+    }
+    if (front) {
+        *path = std::move(l.items.front());
+        l.items.pop_front();
+    } else {
+        *path = std::move(l.items.back());
+        l.items.pop_back();
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _WORKQUEUE_H_
+#define _WORKQUEUE_H_
+
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+/**
+ * Files waiting to be thumbnailed, spread over one lane per worker.
+ *
+ * Each worker takes from the front of its own lane, and steals from the
+ * back of the others' when it runs dry, so that a lane full of slow
+ * documents does not leave the other workers idle.
+ */
+class WorkQueue
+{
+public:
+    explicit WorkQueue(int workers);
+
+    /**
+     * Queue @p path on the next lane, round robin.
+     */
+    void push(const QString &path);
+
+    /**
+     * No more files will be pushed. Workers finish what is queued.
+     */
+    void close();
+
+    /**
+     * Next file for @p worker. Blocks until there is one, and returns
+     * false once the queue is closed and empty.
+     */
+    bool take(int worker, QString *path);
+
+private:
+    struct Lane {
+        QMutex mutex;
+        std::deque<QString> items;
+    };
+
+    bool takeFrom(int lane, bool front, QString *path);
+
+    std::vector<std::unique_ptr<Lane>> m_lanes;
+    std::atomic<size_t> m_next;
+
+    QMutex m_mutex;
+    QWaitCondition m_wait;
+    // Guarded by m_mutex
+    int m_pending;
+    bool m_closed;
+};
+
+#endif
@@ -14,10 +14,13 @@
 #include <KCompressionDevice>
 #include <KPluginFactory>
 
+#include "trace.h"
+
 K_PLUGIN_CLASS_WITH_JSON(BlenderCreator, "blenderthumbnail.json")
 
 BlenderCreator::BlenderCreator(QObject *parent, const QVariantList &args)
     : KIO::ThumbnailCreator(parent, args)
+    , m_dedup(QStringLiteral("blend"))
 {
 }
 
@@ -26,6 +29,22 @@ BlenderCreator::~BlenderCreator() = default;
 // For more info. see https://developer.blender.org/diffusion/B/browse/master/release/bin/blender-thumbnailer.py
 
 KIO::ThumbnailResult BlenderCreator::create(const KIO::ThumbnailRequest &request)
+{
+    // Copies of the same .blend file share their thumbnail
+    ThumbnailDedup::Entry entry;
+    QImage shared;
+    if (m_dedup.isEnabled() && m_dedup.lookup(request.url().toLocalFile(), request.targetSize(), &entry, &shared)) {
+        return KIO::ThumbnailResult::pass(shared);
+    }
+
+    const KIO::ThumbnailResult result = render(request);
+    if (m_dedup.isEnabled() && result.isValid()) {
+        m_dedup.insert(entry, result.image());
+    }
+    return result;
+}
+
+KIO::ThumbnailResult BlenderCreator::render(const KIO::ThumbnailRequest &request)
 {
     std::unique_ptr<QIODevice> device = std::make_unique<QFile>(request.url().toLocalFile());
     if(!device->open(QIODevice::ReadOnly)) {
@@ -33,6 +52,8 @@ KIO::ThumbnailResult BlenderCreator::create(const KIO::ThumbnailRequest &request
     }
 
     // Blender has an option to save files with zstd or gzip compression. First check if we are dealing with such files.
+    // Data is decompressed as it is read, so the block walk includes decompression.
+    TraceSpan openSpan("blend", "decompress-open");
     QByteArray header = device->peek(4);
     if (header.size() == 4) {
         const uint8_t *h = reinterpret_cast<const uint8_t *>(header.constData());
@@ -59,6 +80,9 @@ KIO::ThumbnailResult BlenderCreator::create(const KIO::ThumbnailRequest &request
         }
     }
 
+    openSpan.end();
+
+    TraceSpan walkSpan("blend", "block-walk");
     QDataStream blendStream;
     blendStream.setDevice(device.get());
 
@@ -130,9 +154,14 @@ KIO::ThumbnailResult BlenderCreator::create(const KIO::ThumbnailRequest &request
 
     QByteArray imgBuffer(imgSize, '\0');
     const qint32 readData = blendStream.readRawData(imgBuffer.data(), imgSize);
+    walkSpan.addBytes(device->pos());
+    walkSpan.end();
     if (readData != imgSize) {
         return KIO::ThumbnailResult::fail();
     }
+
+    TraceSpan transformSpan("blend", "pixel-transform");
+    transformSpan.addBytes(imgSize);
     QImage thumbnail((const uchar*)imgBuffer.constData(), x, y, QImage::Format_ARGB32);
     if(request.targetSize().width() != 128) {
         thumbnail = thumbnail.scaledToWidth(request.targetSize().width(), Qt::SmoothTransformation);
@@ -143,6 +172,7 @@ KIO::ThumbnailResult BlenderCreator::create(const KIO::ThumbnailRequest &request
     thumbnail = thumbnail.rgbSwapped();
     thumbnail = thumbnail.mirrored();
     QImage img = thumbnail.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    transformSpan.end();
 
     return !img.isNull() ? KIO::ThumbnailResult::pass(img) : KIO::ThumbnailResult::fail();
 }
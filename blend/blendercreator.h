@@ -9,6 +9,8 @@
 
 #include <KIO/ThumbnailCreator>
 
+#include "thumbnaildedup.h"
+
 class BlenderCreator : public KIO::ThumbnailCreator
 {
 public:
@@ -16,6 +18,11 @@ public:
     ~BlenderCreator() override;
 
     KIO::ThumbnailResult create(const KIO::ThumbnailRequest &request) override;
+
+private:
+    KIO::ThumbnailResult render(const KIO::ThumbnailRequest &request);
+
+    ThumbnailDedup m_dedup;
 };
 
 #endif
@@ -0,0 +1,259 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "thumbnaildedup.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace
+{
+const char indexMagic[4] = {'T', 'D', 'D', 'I'};
+const quint32 indexVersion = 2;
+
+// 4096 slots of 32 bytes: a 128 KiB file
+const int slotBits = 12;
+const quint32 slotCount = 1U << slotBits;
+
+// Bytes hashed at each end of a file for its fingerprint
+const qint64 blockSize = 64 * 1024;
+
+const int fingerprintLength = 20;
+
+struct Header {
+    char magic[4];
+    quint32 version;
+    quint32 slotCount;
+    quint32 slotSize;
+};
+
+struct Slot {
+    uchar fingerprint[fingerprintLength];
+    quint32 flags;
+    quint32 reserved;
+    quint32 checksum;
+};
+
+static_assert(sizeof(Header) == 16, "dedup index header layout changed");
+static_assert(sizeof(Slot) == 32, "dedup index slot layout changed");
+
+enum SlotFlag {
+    Occupied = 0x01,
+};
+
+// FNV-1a over everything in the slot but the checksum itself
+quint32 slotChecksum(const Slot &slot)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(&slot);
+    quint32 hash = 2166136261U;
+    for (size_t i = 0; i < offsetof(Slot, checksum); ++i) {
+        hash = (hash ^ p[i]) * 16777619U;
+    }
+    return hash;
+}
+
+quint32 slotIndex(const QByteArray &fingerprint)
+{
+    quint32 index;
+    memcpy(&index, fingerprint.constData(), sizeof(index));
+    return index & (slotCount - 1);
+}
+
+QByteArray fingerprintOf(QFile &file)
+{
+    const qint64 size = file.size();
+    QCryptographicHash hash(QCryptographicHash::Blake2b_160);
+    hash.addData(QByteArrayView(reinterpret_cast<const char *>(&size), sizeof(size)));
+    hash.addData(file.read(blockSize));
+    if (size > blockSize && file.seek(qMax(blockSize, size - blockSize))) {
+        hash.addData(file.read(blockSize));
+    }
+    return hash.result();
+}
+
+qint64 modified(const QString &path)
+{
+    return QFileInfo(path).fileTime(QFileDevice::FileModificationTime).toMSecsSinceEpoch();
+}
+
+// Whether the files at @p a and @p b hold the same bytes, read side by
+// side up to the first difference
+bool sameContent(const QString &a, const QString &b)
+{
+    QFile first(a);
+    QFile second(b);
+    if (!first.open(QIODevice::ReadOnly) || !second.open(QIODevice::ReadOnly) || first.size() != second.size()) {
+        return false;
+    }
+    for (;;) {
+        const QByteArray block = first.read(blockSize);
+        if (block != second.read(blockSize)) {
+            return false;
+        }
+        if (block.isEmpty()) {
+            return first.atEnd() && second.atEnd();
+        }
+    }
+}
+
+const QString fingerprintKey = QStringLiteral("Dedup::Fingerprint");
+const QString sourceKey = QStringLiteral("Dedup::Source");
+const QString modifiedKey = QStringLiteral("Dedup::Modified");
+const QString wraparoundKey = QStringLiteral("Dedup::Wraparound");
+}
+
+ThumbnailDedup::ThumbnailDedup(const QString &creator)
+    : m_creator(creator)
+    , m_map(nullptr)
+{
+    if (qEnvironmentVariableIntValue("THUMBNAILER_DEDUP") <= 0) {
+        return;
+    }
+    if (!open()) {
+        m_file.close();
+    }
+}
+
+ThumbnailDedup::~ThumbnailDedup() = default;
+
+bool ThumbnailDedup::isEnabled() const
+{
+    return m_map != nullptr;
+}
+
+bool ThumbnailDedup::open()
+{
+    m_directory = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/kdegraphics-thumbnailers/dedup");
+    if (!QDir().mkpath(m_directory)) {
+        return false;
+    }
+
+    m_file.setFileName(m_directory + QLatin1String("/index"));
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    const qint64 length = sizeof(Header) + qint64(slotCount) * sizeof(Slot);
+    Header header;
+    const bool valid = m_file.size() == length //
+        && m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) == sizeof(header) //
+        && memcmp(header.magic, indexMagic, sizeof(indexMagic)) == 0 //
+        && header.version == indexVersion //
+        && header.slotCount == slotCount //
+        && header.slotSize == sizeof(Slot);
+
+    if (!valid) {
+        // New, damaged or from another version: start from scratch
+        if (!m_file.resize(0) || !m_file.resize(length)) {
+            return false;
+        }
+        memcpy(header.magic, indexMagic, sizeof(indexMagic));
+        header.version = indexVersion;
+        header.slotCount = slotCount;
+        header.slotSize = sizeof(Slot);
+        if (!m_file.seek(0) || m_file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header) || !m_file.flush()) {
+            return false;
+        }
+    }
+
+    m_map = m_file.map(0, length);
+    return m_map != nullptr;
+}
+
+QString ThumbnailDedup::thumbnailPath(quint32 slot, const QSize &size) const
+{
+    return m_directory + QStringLiteral("/%1-%2-%3x%4.png").arg(slot).arg(m_creator).arg(size.width()).arg(size.height());
+}
+
+bool ThumbnailDedup::lookup(const QString &path, const QSize &size, Entry *entry, QImage *image) const
+{
+    if (!m_map) {
+        return false;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    entry->path = path;
+    entry->size = size;
+    entry->fingerprint = fingerprintOf(file);
+    file.close();
+
+    // Copy the slot out first, another process may be writing it
+    const quint32 index = slotIndex(entry->fingerprint);
+    Slot slot;
+    memcpy(&slot, m_map + sizeof(Header) + index * sizeof(Slot), sizeof(slot));
+
+    if (!(slot.flags & Occupied) || slot.checksum != slotChecksum(slot)) {
+        return false;
+    }
+    if (memcmp(slot.fingerprint, entry->fingerprint.constData(), fingerprintLength) != 0) {
+        return false;
+    }
+
+    // The slot may have been given to another file since the thumbnail
+    // was written
+    QImageReader reader(thumbnailPath(index, size));
+    if (reader.text(fingerprintKey) != QString::fromLatin1(entry->fingerprint.toHex())) {
+        return false;
+    }
+
+    // The file the thumbnail was made from, as long as it has not been
+    // changed since, or another one with the same content
+    const QString source = reader.text(sourceKey);
+    if (source.isEmpty() || reader.text(modifiedKey).toLongLong() != modified(source)) {
+        return false;
+    }
+    if (source != path && !sameContent(path, source)) {
+        return false;
+    }
+
+    bool ok = false;
+    const float wraparoundPoint = reader.text(wraparoundKey).toFloat(&ok);
+    if (!reader.read(image)) {
+        return false;
+    }
+    entry->wraparoundPoint = ok ? wraparoundPoint : -1;
+    return true;
+}
+
+void ThumbnailDedup::insert(const Entry &entry, const QImage &image)
+{
+    if (!m_map || entry.fingerprint.size() != fingerprintLength || image.isNull()) {
+        return;
+    }
+
+    const quint32 index = slotIndex(entry.fingerprint);
+
+    QImage tagged = image;
+    tagged.setText(fingerprintKey, QString::fromLatin1(entry.fingerprint.toHex()));
+    tagged.setText(sourceKey, entry.path);
+    tagged.setText(modifiedKey, QString::number(modified(entry.path)));
+    if (entry.wraparoundPoint > 0) {
+        tagged.setText(wraparoundKey, QString::number(entry.wraparoundPoint));
+    }
+    QSaveFile out(thumbnailPath(index, entry.size));
+    if (!out.open(QIODevice::WriteOnly) || !tagged.save(&out, "PNG") || !out.commit()) {
+        return;
+    }
+
+    Slot slot;
+    memset(&slot, 0, sizeof(slot));
+    memcpy(slot.fingerprint, entry.fingerprint.constData(), fingerprintLength);
+    slot.flags = Occupied;
+    slot.checksum = slotChecksum(slot);
+
+    memcpy(m_map + sizeof(Header) + index * sizeof(Slot), &slot, sizeof(slot));
+}
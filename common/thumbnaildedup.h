@@ -0,0 +1,76 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _THUMBNAILDEDUP_H_
+#define _THUMBNAILDEDUP_H_
+
+#include <QByteArray>
+#include <QFile>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+/**
+ * Shares thumbnails between byte-identical files in different places,
+ * so that a copy costs a comparison instead of a rendering. Enabled by
+ * setting THUMBNAILER_DEDUP=1.
+ *
+ * A file is identified by a fingerprint of its size and its first and
+ * last 64 KiB. A mapped index in the user's cache directory holds the
+ * fingerprints of the files thumbnails were made from. The thumbnails
+ * themselves are PNG files next to the index, one per index slot,
+ * creator and size, tagged with the fingerprint, path and modification
+ * time of the file they were made from.
+ *
+ * Nothing but the fingerprint is read of a file that is not found, so
+ * rendering a new document costs no more than its two end blocks. Only
+ * when another file has the same fingerprint are the two compared in
+ * full, to rule out files that merely start and end the same.
+ */
+class ThumbnailDedup
+{
+public:
+    struct Entry {
+        QString path;
+        QSize size;
+        QByteArray fingerprint;
+        // Of the thumbnail found or to insert, see
+        // KIO::ThumbnailResult::sequenceIndexWraparoundPoint()
+        float wraparoundPoint = -1;
+    };
+
+    /**
+     * @p creator names the thumbnailer, thumbnails of different
+     * creators are kept apart.
+     */
+    explicit ThumbnailDedup(const QString &creator);
+    ~ThumbnailDedup();
+
+    bool isEnabled() const;
+
+    /**
+     * Look for a thumbnail of @p size for the content of the file at
+     * @p path. @p entry is filled in for a later insert() on a miss.
+     */
+    bool lookup(const QString &path, const QSize &size, Entry *entry, QImage *image) const;
+
+    /**
+     * Remember @p image as the thumbnail for @p entry, as filled in by
+     * a lookup() that missed, with its wraparound point set.
+     */
+    void insert(const Entry &entry, const QImage &image);
+
+private:
+    bool open();
+    QString thumbnailPath(quint32 slot, const QSize &size) const;
+
+    QString m_creator;
+    QString m_directory;
+    QFile m_file;
+    uchar *m_map;
+};
+
+#endif
@@ -0,0 +1,81 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "trace.h"
+
+#include <QThread>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Q_LOGGING_CATEGORY(THUMBNAILERS_TRACE, "org.kde.kdegraphics.thumbnailers.trace", QtWarningMsg)
+
+namespace
+{
+// The trace file, opened on first use, or -1
+int traceFile()
+{
+    static const int fd = [] {
+        const QByteArray path = qgetenv("THUMBNAILER_TRACE_FILE");
+        if (path.isEmpty()) {
+            return -1;
+        }
+        const int fd = open(path.constData(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        struct stat st;
+        if (fd != -1 && fstat(fd, &st) == 0 && st.st_size == 0) {
+            // The JSON array format, in which the closing bracket is
+            // optional, so that any number of processes can append
+            const char start[] = "[\n";
+            (void)write(fd, start, sizeof(start) - 1);
+        }
+        return fd;
+    }();
+    return fd;
+}
+}
+
+bool Trace::chromeTraceEnabled()
+{
+    static const bool enabled = qEnvironmentVariableIsSet("THUMBNAILER_TRACE_FILE");
+    return enabled;
+}
+
+void Trace::report(const char *creator,
+                   const char *stage,
+                   std::chrono::steady_clock::time_point start,
+                   std::chrono::steady_clock::time_point end,
+                   qint64 bytes)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    const long long begin = duration_cast<microseconds>(start.time_since_epoch()).count();
+    const long long duration = duration_cast<microseconds>(end - start).count();
+
+    qCDebug(THUMBNAILERS_TRACE, "%s %s: %lld us, %lld bytes", creator, stage, duration, static_cast<long long>(bytes));
+
+    const int fd = traceFile();
+    if (fd == -1) {
+        return;
+    }
+    // One write() per event, which O_APPEND keeps whole
+    char event[512];
+    const int length = snprintf(event,
+                                sizeof(event),
+                                "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%d,\"tid\":%llu,\"args\":{\"bytes\":%lld}},\n",
+                                stage,
+                                creator,
+                                begin,
+                                duration,
+                                int(getpid()),
+                                static_cast<unsigned long long>(reinterpret_cast<quintptr>(QThread::currentThreadId())),
+                                static_cast<long long>(bytes));
+    if (length > 0 && length < int(sizeof(event))) {
+        (void)write(fd, event, length);
+    }
+}
@@ -0,0 +1,93 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <QLoggingCategory>
+
+#include <chrono>
+
+Q_DECLARE_LOGGING_CATEGORY(THUMBNAILERS_TRACE)
+
+/**
+ * Timing of the stages of thumbnail creation, for profiling in
+ * production without rebuilding.
+ *
+ * Spans are reported when either
+ *  - debug output of the org.kde.kdegraphics.thumbnailers.trace logging
+ *    category is enabled, e.g. through QT_LOGGING_RULES, or
+ *  - THUMBNAILER_TRACE_FILE names a file, to which they are appended as
+ *    Chrome trace events (chrome://tracing, Perfetto).
+ *
+ * Otherwise a span costs one check when it is created.
+ */
+namespace Trace
+{
+bool chromeTraceEnabled();
+
+inline bool isEnabled()
+{
+    return THUMBNAILERS_TRACE().isDebugEnabled() || chromeTraceEnabled();
+}
+
+void report(const char *creator,
+            const char *stage,
+            std::chrono::steady_clock::time_point start,
+            std::chrono::steady_clock::time_point end,
+            qint64 bytes);
+}
+
+/**
+ * Measures the stage @p stage of the creator @p creator, from its
+ * construction to end() or its destruction. Both names must be string
+ * literals.
+ */
+class TraceSpan
+{
+public:
+    TraceSpan(const char *creator, const char *stage)
+        : m_creator(creator)
+        , m_stage(stage)
+        , m_enabled(Trace::isEnabled())
+    {
+        if (m_enabled) {
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~TraceSpan()
+    {
+        end();
+    }
+
+    /**
+     * Count @p bytes as processed by this stage.
+     */
+    void addBytes(qint64 bytes)
+    {
+        m_bytes += bytes;
+    }
+
+    void end()
+    {
+        if (m_enabled) {
+            m_enabled = false;
+            Trace::report(m_creator, m_stage, m_start, std::chrono::steady_clock::now(), m_bytes);
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+
+    const char *m_creator;
+    const char *m_stage;
+    bool m_enabled;
+    qint64 m_bytes = 0;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#endif
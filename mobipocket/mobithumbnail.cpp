@@ -11,6 +11,8 @@
 
 #include <KPluginFactory>
 
+#include "trace.h"
+
 K_PLUGIN_CLASS_WITH_JSON(MobiThumbnail, "mobithumbnail.json")
 
 MobiThumbnail::MobiThumbnail(QObject *parent, const QVariantList &args)
@@ -24,11 +26,15 @@ KIO::ThumbnailResult MobiThumbnail::create(const KIO::ThumbnailRequest &request)
     if (file.open(QFile::ReadOnly)) {
         return KIO::ThumbnailResult::fail();
     }
+    TraceSpan parseSpan("mobi", "parse");
     Mobipocket::Document doc(&file);
     if (!doc.isValid()) {
         return KIO::ThumbnailResult::fail();
     }
+    parseSpan.end();
+    TraceSpan coverSpan("mobi", "cover-decode");
     QImage img = doc.thumbnail();
+    coverSpan.end();
     return !img.isNull() ? KIO::ThumbnailResult::pass(img) : KIO::ThumbnailResult::fail();
 }
 
@@ -0,0 +1,281 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "dscindex.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <QDir>
+#include <QStandardPaths>
+
+namespace
+{
+const char indexMagic[4] = {'D', 'S', 'C', 'I'};
+const quint32 indexVersion = 6;
+
+// 4096 slots of 160 bytes: a 640 KiB file
+const int slotBits = 12;
+const quint32 slotCount = 1U << slotBits;
+
+struct Header {
+    char magic[4];
+    quint32 version;
+    quint32 slotCount;
+    quint32 slotSize;
+};
+
+// Native byte order: the index is a per-user cache, never shared
+// between machines.
+struct Slot {
+    quint64 device;
+    quint64 inode;
+    qint64 mtime;
+    qint64 size;
+    quint64 beginPreview;
+    quint64 endPreview;
+    quint64 prolog[2];
+    quint64 setup[2];
+    quint64 page[2];
+    quint64 photoshop[2];
+    qint64 failedAt;
+    qint32 bbox[4];
+    quint32 pageCount;
+    quint16 preview;
+    quint16 flags;
+    quint16 media[2];
+    quint16 failure;
+    quint16 failures;
+    quint32 failureVersion;
+    quint32 checksum;
+};
+
+static_assert(sizeof(Header) == 16, "DSC index header layout changed");
+static_assert(sizeof(Slot) == 160, "DSC index slot layout changed");
+
+enum SlotFlag {
+    Occupied = 0x01,
+    Dvi = 0x02,
+    Pjl = 0x04,
+    CtrlD = 0x08,
+    HasBBox = 0x10,
+    Pdf = 0x20,
+};
+
+// FNV-1a over everything in the slot but the checksum itself
+quint32 slotChecksum(const Slot &slot)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(&slot);
+    quint32 hash = 2166136261U;
+    for (size_t i = 0; i < offsetof(Slot, checksum); ++i) {
+        hash = (hash ^ p[i]) * 16777619U;
+    }
+    return hash;
+}
+
+// Must give the same answer in every process using the index
+quint32 slotIndex(const DSCIndex::Key &key)
+{
+    const quint64 id = key.inode ^ ((key.device << 32) | (key.device >> 32));
+    return static_cast<quint32>((id * 0x9e3779b97f4a7c15ULL) >> (64 - slotBits));
+}
+
+bool holds(const Slot &slot, const DSCIndex::Key &key)
+{
+    return (slot.flags & Occupied) && slot.checksum == slotChecksum(slot) //
+        && slot.device == key.device && slot.inode == key.inode && slot.mtime == key.mtime && slot.size == key.size;
+}
+}
+
+bool DSCIndex::fileKey(const QString &path, Key *key)
+{
+    struct stat st;
+    if (stat(QFile::encodeName(path).constData(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+
+    key->device = st.st_dev;
+    key->inode = st.st_ino;
+    key->mtime = qint64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    key->size = st.st_size;
+    return true;
+}
+
+DSCIndex::DSCIndex()
+    : m_map(nullptr)
+{
+    if (!open()) {
+        m_file.close();
+    }
+}
+
+DSCIndex::~DSCIndex() = default;
+
+bool DSCIndex::isValid() const
+{
+    return m_map != nullptr;
+}
+
+bool DSCIndex::open()
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/kdegraphics-thumbnailers");
+    if (!QDir().mkpath(dir)) {
+        return false;
+    }
+
+    m_file.setFileName(dir + QLatin1String("/dscindex"));
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    const qint64 length = sizeof(Header) + qint64(slotCount) * sizeof(Slot);
+    Header header;
+    const bool valid = m_file.size() == length //
+        && m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) == sizeof(header) //
+        && memcmp(header.magic, indexMagic, sizeof(indexMagic)) == 0 //
+        && header.version == indexVersion //
+        && header.slotCount == slotCount //
+        && header.slotSize == sizeof(Slot);
+
+    if (!valid) {
+        // New, damaged or from another version: start from scratch
+        if (!m_file.resize(0) || !m_file.resize(length)) {
+            return false;
+        }
+        memcpy(header.magic, indexMagic, sizeof(indexMagic));
+        header.version = indexVersion;
+        header.slotCount = slotCount;
+        header.slotSize = sizeof(Slot);
+        if (!m_file.seek(0) || m_file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header) || !m_file.flush()) {
+            return false;
+        }
+    }
+
+    m_map = m_file.map(0, length);
+    return m_map != nullptr;
+}
+
+bool DSCIndex::lookup(const Key &key, DSCSummary *summary) const
+{
+    if (!m_map) {
+        return false;
+    }
+
+    // Copy the slot out first, another process may be writing it
+    Slot slot;
+    memcpy(&slot, m_map + sizeof(Header) + slotIndex(key) * sizeof(Slot), sizeof(slot));
+
+    if (!holds(slot, key)) {
+        return false;
+    }
+
+    summary->dvi = slot.flags & Dvi;
+    summary->pdf = slot.flags & Pdf;
+    summary->pjl = slot.flags & Pjl;
+    summary->ctrld = slot.flags & CtrlD;
+    summary->hasBBox = slot.flags & HasBBox;
+    summary->llx = slot.bbox[0];
+    summary->lly = slot.bbox[1];
+    summary->urx = slot.bbox[2];
+    summary->ury = slot.bbox[3];
+    summary->pageCount = slot.pageCount;
+    summary->mediaWidth = slot.media[0];
+    summary->mediaHeight = slot.media[1];
+    summary->preview = slot.preview;
+    summary->beginPreview = slot.beginPreview;
+    summary->endPreview = slot.endPreview;
+    summary->beginProlog = slot.prolog[0];
+    summary->endProlog = slot.prolog[1];
+    summary->beginSetup = slot.setup[0];
+    summary->endSetup = slot.setup[1];
+    summary->beginPage = slot.page[0];
+    summary->endPage = slot.page[1];
+    summary->beginPhotoshop = slot.photoshop[0];
+    summary->endPhotoshop = slot.photoshop[1];
+    return true;
+}
+
+void DSCIndex::insert(const Key &key, const DSCSummary &summary)
+{
+    if (!m_map) {
+        return;
+    }
+
+    Slot slot;
+    memset(&slot, 0, sizeof(slot));
+    slot.device = key.device;
+    slot.inode = key.inode;
+    slot.mtime = key.mtime;
+    slot.size = key.size;
+    slot.beginPreview = summary.beginPreview;
+    slot.endPreview = summary.endPreview;
+    slot.prolog[0] = summary.beginProlog;
+    slot.prolog[1] = summary.endProlog;
+    slot.setup[0] = summary.beginSetup;
+    slot.setup[1] = summary.endSetup;
+    slot.page[0] = summary.beginPage;
+    slot.page[1] = summary.endPage;
+    slot.photoshop[0] = summary.beginPhotoshop;
+    slot.photoshop[1] = summary.endPhotoshop;
+    slot.bbox[0] = summary.llx;
+    slot.bbox[1] = summary.lly;
+    slot.bbox[2] = summary.urx;
+    slot.bbox[3] = summary.ury;
+    slot.pageCount = summary.pageCount;
+    slot.media[0] = quint16(qBound(0, summary.mediaWidth, 0xffff));
+    slot.media[1] = quint16(qBound(0, summary.mediaHeight, 0xffff));
+    slot.preview = summary.preview;
+    slot.flags = Occupied //
+        | (summary.dvi ? Dvi : 0) //
+        | (summary.pdf ? Pdf : 0) //
+        | (summary.pjl ? Pjl : 0) //
+        | (summary.ctrld ? CtrlD : 0) //
+        | (summary.hasBBox ? HasBBox : 0);
+    slot.checksum = slotChecksum(slot);
+
+    memcpy(m_map + sizeof(Header) + slotIndex(key) * sizeof(Slot), &slot, sizeof(slot));
+}
+
+bool DSCIndex::lookupFailure(const Key &key, Failure *failure) const
+{
+    if (!m_map) {
+        return false;
+    }
+
+    Slot slot;
+    memcpy(&slot, m_map + sizeof(Header) + slotIndex(key) * sizeof(Slot), sizeof(slot));
+    if (!holds(slot, key) || slot.failure == Failure::None || slot.failure > Failure::BadOutput) {
+        return false;
+    }
+
+    failure->kind = static_cast<Failure::Kind>(slot.failure);
+    failure->count = slot.failures;
+    failure->time = slot.failedAt;
+    failure->version = slot.failureVersion;
+    return true;
+}
+
+void DSCIndex::insertFailure(const Key &key, const Failure &failure)
+{
+    if (!m_map) {
+        return;
+    }
+
+    uchar *at = m_map + sizeof(Header) + slotIndex(key) * sizeof(Slot);
+    Slot slot;
+    memcpy(&slot, at, sizeof(slot));
+    if (!holds(slot, key)) {
+        return;
+    }
+
+    slot.failure = failure.kind;
+    slot.failures = quint16(qMin(failure.count, 0xffffU));
+    slot.failedAt = failure.time;
+    slot.failureVersion = failure.version;
+    slot.checksum = slotChecksum(slot);
+    memcpy(at, &slot, sizeof(slot));
+}
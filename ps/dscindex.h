@@ -0,0 +1,140 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _DSCINDEX_H_
+#define _DSCINDEX_H_
+
+#include <QFile>
+#include <QHashFunctions>
+#include <QString>
+
+/**
+ * What GSCreator needs to know about a document before rendering it,
+ * as found by parsing its DSC comments.
+ */
+struct DSCSummary
+{
+    bool dvi = false;
+    bool pdf = false;
+    bool pjl = false;
+    bool ctrld = false;
+    bool hasBBox = false;
+    int llx = 0;
+    int lly = 0;
+    int urx = 0;
+    int ury = 0;
+    unsigned int pageCount = 0;
+    // Size of the pages in points, 0 if unknown
+    int mediaWidth = 0;
+    int mediaHeight = 0;
+    unsigned int preview = 0; // CDSC_PREVIEW_TYPE
+    quint64 beginPreview = 0;
+    quint64 endPreview = 0;
+
+    // Where the prolog, the document setup and the first page are,
+    // if the document was scanned that far. Empty ranges are unknown.
+    quint64 beginProlog = 0;
+    quint64 endProlog = 0;
+    quint64 beginSetup = 0;
+    quint64 endSetup = 0;
+    quint64 beginPage = 0;
+    quint64 endPage = 0;
+
+    // The image resources of Photoshop EPS files, which hold their
+    // thumbnail, from the %BeginPhotoshop: line to the end of the
+    // %EndPhotoshop one
+    quint64 beginPhotoshop = 0;
+    quint64 endPhotoshop = 0;
+};
+
+/**
+ * On-disk cache of DSCSummary records, so that asking for the same
+ * document again, e.g. at another thumbnail size, skips parsing it.
+ *
+ * The index is a file of a fixed number of fixed-layout slots in the
+ * user's cache directory, mapped into memory. A document is identified
+ * by device, inode, modification time and size, and hashes to a single
+ * slot, evicting whatever was there before. Each slot carries a
+ * checksum, so that one torn by a concurrent writer in another
+ * thumbnailer process reads as a miss. A slot also keeps the last
+ * failure to render its document.
+ */
+class DSCIndex
+{
+public:
+    struct Key {
+        quint64 device;
+        quint64 inode;
+        qint64 mtime; // nanoseconds
+        qint64 size;
+    };
+
+    /**
+     * The last time rendering a document failed, so that the next
+     * request for it can give up at once.
+     */
+    struct Failure {
+        enum Kind {
+            None,
+            Timeout,
+            Crash,
+            BadOutput,
+        };
+        Kind kind = None;
+        // In a row, counting this one
+        unsigned int count = 0;
+        // Seconds since the epoch
+        qint64 time = 0;
+        // Of the renderer that failed, a later one may succeed
+        quint32 version = 0;
+    };
+
+    /**
+     * Identify the file at @p path. Returns false if it cannot be
+     * stat()ed, in which case it should not be indexed.
+     */
+    static bool fileKey(const QString &path, Key *key);
+
+    DSCIndex();
+    ~DSCIndex();
+
+    bool isValid() const;
+
+    bool lookup(const Key &key, DSCSummary *summary) const;
+    void insert(const Key &key, const DSCSummary &summary);
+
+    bool lookupFailure(const Key &key, Failure *failure) const;
+
+    /**
+     * Record @p failure for a document already in the index, or clear
+     * it with a Failure of kind None.
+     *
+     * A failure is kept in the slot of the document's summary, so only
+     * indexed documents are covered: nothing is recorded when the
+     * index could not be opened, or when another document took the
+     * slot in the meantime, and the failure goes with the slot when
+     * it is evicted.
+     */
+    void insertFailure(const Key &key, const Failure &failure);
+
+private:
+    bool open();
+
+    QFile m_file;
+    uchar *m_map;
+};
+
+inline bool operator==(const DSCIndex::Key &a, const DSCIndex::Key &b)
+{
+    return a.device == b.device && a.inode == b.inode && a.mtime == b.mtime && a.size == b.size;
+}
+
+inline size_t qHash(const DSCIndex::Key &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.device, key.inode, key.mtime, key.size);
+}
+
+#endif
@@ -88,7 +88,9 @@ dsc_private void dsc_memfree(P2(CDSC*dsc, void *ptr));
 dsc_private CDSC * dsc_init2(P1(CDSC *dsc));
 dsc_private void dsc_reset(P1(CDSC *dsc));
 dsc_private void dsc_section_join(P3(unsigned long begin, unsigned long *pend, unsigned long **pplast));
+dsc_private char * dsc_find_eol(P2(char *line, char *last));
 dsc_private int dsc_read_line(P1(CDSC *dsc));
+dsc_private void dsc_comment(P1(CDSC *dsc));
 dsc_private int dsc_read_doseps(P1(CDSC *dsc));
 dsc_private char * dsc_alloc_string(P3(CDSC *dsc, const char *str, int len));
 dsc_private char * dsc_add_line(P3(CDSC *dsc, const char *line, unsigned int len));
@@ -101,7 +103,10 @@ dsc_private float dsc_get_real(P3(const char *line, unsigned int len,
     unsigned int *offset));
 dsc_private int dsc_stricmp(P2(const char *s, const char *t));
 dsc_private void dsc_unknown(P1(CDSC *dsc)); 
-dsc_private GSBOOL dsc_is_section(char *line);
+dsc_private void dsc_mark_atend(P2(CDSC *dsc, unsigned int flag));
+dsc_private int dsc_scan_photoshop(P1(CDSC *dsc));
+dsc_private int dsc_keyword(P2(const char *line, unsigned int length));
+dsc_private GSBOOL dsc_is_section(P1(int keyword));
 dsc_private int dsc_parse_pages(P1(CDSC *dsc));
 dsc_private int dsc_parse_bounding_box(P3(CDSC *dsc, CDSCBBOX** pbbox, int offset));
 dsc_private int dsc_parse_float_bounding_box(P3(CDSC *dsc, CDSCFBBOX** pfbbox, int offset));
@@ -230,6 +235,217 @@ static const char * const dsc_scan_section_name[15] = {
  "EOF"
 };
 
+/* DSC comment keywords, the text following %%. */
+/* No keyword is a prefix of another. */
+enum CDSC_KEYWORD {
+    DSC_KW_NONE = 0,
+    DSC_KW_CONTINUED,			/* %%+ */
+    DSC_KW_BEGINBINARY,			/* %%BeginBinary: */
+    DSC_KW_BEGINCOMMENTS,		/* %%BeginComments */
+    DSC_KW_BEGINDATA,			/* %%BeginData: */
+    DSC_KW_BEGINDEFAULTS,		/* %%BeginDefaults */
+    DSC_KW_BEGINDOCUMENT,		/* %%BeginDocument: */
+    DSC_KW_BEGINFEATURE,		/* %%BeginFeature: */
+    DSC_KW_BEGINFONT,			/* %%BeginFont: */
+    DSC_KW_BEGINPAGESETUP,		/* %%BeginPageSetup */
+    DSC_KW_BEGINPREVIEW,		/* %%BeginPreview */
+    DSC_KW_BEGINPROCSET,		/* %%BeginProcSet: */
+    DSC_KW_BEGINPROLOG,			/* %%BeginProlog */
+    DSC_KW_BEGINRESOURCE,		/* %%BeginResource: */
+    DSC_KW_BEGINSETUP,			/* %%BeginSetup */
+    DSC_KW_BOUNDINGBOX,			/* %%BoundingBox: */
+    DSC_KW_CREATIONDATE,		/* %%CreationDate: */
+    DSC_KW_CREATOR,			/* %%Creator: */
+    DSC_KW_CROPBOX,			/* %%CropBox: */
+    DSC_KW_DOCUMENTDATA,		/* %%DocumentData: */
+    DSC_KW_DOCUMENTMEDIA,		/* %%DocumentMedia: */
+    DSC_KW_DOCUMENTNEEDEDFONTS,		/* %%DocumentNeededFonts: */
+    DSC_KW_DOCUMENTPAPERCOLORS,		/* %%DocumentPaperColors: */
+    DSC_KW_DOCUMENTPAPERFORMS,		/* %%DocumentPaperForms: */
+    DSC_KW_DOCUMENTPAPERSIZES,		/* %%DocumentPaperSizes: */
+    DSC_KW_DOCUMENTPAPERWEIGHTS,	/* %%DocumentPaperWeights: */
+    DSC_KW_DOCUMENTSUPPLIEDFONTS,	/* %%DocumentSuppliedFonts: */
+    DSC_KW_EOF,				/* %%EOF */
+    DSC_KW_ENDBINARY,			/* %%EndBinary */
+    DSC_KW_ENDCOMMENTS,			/* %%EndComments */
+    DSC_KW_ENDDATA,			/* %%EndData */
+    DSC_KW_ENDDEFAULTS,			/* %%EndDefaults */
+    DSC_KW_ENDDOCUMENT,			/* %%EndDocument */
+    DSC_KW_ENDFEATURE,			/* %%EndFeature */
+    DSC_KW_ENDFONT,			/* %%EndFont */
+    DSC_KW_ENDPAGESETUP,		/* %%EndPageSetup */
+    DSC_KW_ENDPREVIEW,			/* %%EndPreview */
+    DSC_KW_ENDPROCSET,			/* %%EndProcSet */
+    DSC_KW_ENDPROLOG,			/* %%EndProlog */
+    DSC_KW_ENDRESOURCE,			/* %%EndResource */
+    DSC_KW_ENDSETUP,			/* %%EndSetup */
+    DSC_KW_FEATURE,			/* %%Feature: */
+    DSC_KW_FOR,				/* %%For: */
+    DSC_KW_HIRESBOUNDINGBOX,		/* %%HiResBoundingBox: */
+    DSC_KW_INCLUDEFONT,			/* %%IncludeFont: */
+    DSC_KW_LANGUAGELEVEL,		/* %%LanguageLevel: */
+    DSC_KW_ORIENTATION,			/* %%Orientation: */
+    DSC_KW_PAGE,			/* %%Page: */
+    DSC_KW_PAGEBOUNDINGBOX,		/* %%PageBoundingBox: */
+    DSC_KW_PAGEMEDIA,			/* %%PageMedia: */
+    DSC_KW_PAGEORDER,			/* %%PageOrder: */
+    DSC_KW_PAGEORIENTATION,		/* %%PageOrientation: */
+    DSC_KW_PAGETRAILER,			/* %%PageTrailer */
+    DSC_KW_PAGES,			/* %%Pages: */
+    DSC_KW_PAPERCOLOR,			/* %%PaperColor: */
+    DSC_KW_PAPERFORM,			/* %%PaperForm: */
+    DSC_KW_PAPERSIZE,			/* %%PaperSize: */
+    DSC_KW_PAPERWEIGHT,			/* %%PaperWeight: */
+    DSC_KW_REQUIREMENTS,		/* %%Requirements: */
+    DSC_KW_TITLE,			/* %%Title: */
+    DSC_KW_TRAILER,			/* %%Trailer */
+    DSC_KW_VIEWINGORIENTATION,		/* %%ViewingOrientation: */
+    DSC_KW_COUNT
+};
+
+typedef struct CDSCKEYWORD_S {
+    const char *name;
+    unsigned int length;
+} CDSCKEYWORD;
+
+dsc_private const CDSCKEYWORD dsc_keywords[DSC_KW_COUNT] = {
+    {NULL, 0},
+    {"+", 1},
+    {"BeginBinary:", 12},
+    {"BeginComments", 13},
+    {"BeginData:", 10},
+    {"BeginDefaults", 13},
+    {"BeginDocument:", 14},
+    {"BeginFeature:", 13},
+    {"BeginFont:", 10},
+    {"BeginPageSetup", 14},
+    {"BeginPreview", 12},
+    {"BeginProcSet:", 13},
+    {"BeginProlog", 11},
+    {"BeginResource:", 14},
+    {"BeginSetup", 10},
+    {"BoundingBox:", 12},
+    {"CreationDate:", 13},
+    {"Creator:", 8},
+    {"CropBox:", 8},
+    {"DocumentData:", 13},
+    {"DocumentMedia:", 14},
+    {"DocumentNeededFonts:", 20},
+    {"DocumentPaperColors:", 20},
+    {"DocumentPaperForms:", 19},
+    {"DocumentPaperSizes:", 19},
+    {"DocumentPaperWeights:", 21},
+    {"DocumentSuppliedFonts:", 22},
+    {"EOF", 3},
+    {"EndBinary", 9},
+    {"EndComments", 11},
+    {"EndData", 7},
+    {"EndDefaults", 11},
+    {"EndDocument", 11},
+    {"EndFeature", 10},
+    {"EndFont", 7},
+    {"EndPageSetup", 12},
+    {"EndPreview", 10},
+    {"EndProcSet", 10},
+    {"EndProlog", 9},
+    {"EndResource", 11},
+    {"EndSetup", 8},
+    {"Feature:", 8},
+    {"For:", 4},
+    {"HiResBoundingBox:", 17},
+    {"IncludeFont:", 12},
+    {"LanguageLevel:", 14},
+    {"Orientation:", 12},
+    {"Page:", 5},
+    {"PageBoundingBox:", 16},
+    {"PageMedia:", 10},
+    {"PageOrder:", 10},
+    {"PageOrientation:", 16},
+    {"PageTrailer", 11},
+    {"Pages:", 6},
+    {"PaperColor:", 11},
+    {"PaperForm:", 10},
+    {"PaperSize:", 10},
+    {"PaperWeight:", 12},
+    {"Requirements:", 13},
+    {"Title:", 6},
+    {"Trailer", 7},
+    {"ViewingOrientation:", 19},
+};
+
+#define DSC_KEYWORD_MAX 22	/* length of longest keyword */
+#define DSC_KEYWORD_SEED 2629	/* FNV-1a offset basis for which */
+				/* no two keywords share a slot */
+
+/* Perfect hash of the keywords: slot (FNV-1a hash >> 24) holds the */
+/* keyword with that hash.  Regenerate when adding a keyword. */
+dsc_private const unsigned char dsc_keyword_slot[256] = {
+    0, 0, DSC_KW_FEATURE, 0,
+    0, 0, 0, 0,
+    0, 0, 0, 0,
+    0, 0, 0, 0,
+    0, DSC_KW_CREATIONDATE, 0, 0,
+    0, DSC_KW_BEGINBINARY, 0, 0,
+    0, 0, 0, 0,
+    DSC_KW_PAGEORIENTATION, DSC_KW_ENDSETUP, 0, DSC_KW_DOCUMENTPAPERSIZES,
+    0, 0, DSC_KW_PAGEBOUNDINGBOX, 0,
+    DSC_KW_ENDRESOURCE, 0, 0, 0,
+    0, 0, 0, 0,
+    0, 0, DSC_KW_BEGINPREVIEW, DSC_KW_REQUIREMENTS,
+    0, 0, 0, 0,
+    0, 0, 0, DSC_KW_ENDDOCUMENT,
+    0, DSC_KW_ORIENTATION, DSC_KW_DOCUMENTNEEDEDFONTS, 0,
+    0, DSC_KW_PAPERCOLOR, 0, DSC_KW_PAPERWEIGHT,
+    0, DSC_KW_PAGEORDER, DSC_KW_BEGINSETUP, 0,
+    0, 0, DSC_KW_ENDDEFAULTS, 0,
+    0, DSC_KW_BEGINDATA, 0, 0,
+    0, 0, 0, 0,
+    DSC_KW_PAPERFORM, 0, 0, 0,
+    DSC_KW_BEGINFEATURE, DSC_KW_BEGINPROLOG, 0, 0,
+    0, 0, 0, 0,
+    0, 0, 0, DSC_KW_PAGES,
+    0, 0, DSC_KW_BEGINFONT, 0,
+    0, 0, 0, 0,
+    0, DSC_KW_BEGINDOCUMENT, 0, 0,
+    DSC_KW_TITLE, 0, DSC_KW_CONTINUED, 0,
+    0, 0, 0, 0,
+    0, 0, 0, DSC_KW_BEGINDEFAULTS,
+    DSC_KW_FOR, 0, DSC_KW_BEGINRESOURCE, DSC_KW_EOF,
+    0, 0, DSC_KW_ENDBINARY, 0,
+    DSC_KW_VIEWINGORIENTATION, 0, DSC_KW_ENDPREVIEW, 0,
+    DSC_KW_DOCUMENTDATA, 0, 0, 0,
+    0, 0, 0, DSC_KW_BEGINCOMMENTS,
+    0, 0, DSC_KW_CREATOR, 0,
+    0, DSC_KW_PAPERSIZE, 0, DSC_KW_ENDDATA,
+    0, 0, 0, 0,
+    0, 0, 0, 0,
+    0, 0, 0, 0,
+    DSC_KW_DOCUMENTSUPPLIEDFONTS, 0, 0, DSC_KW_ENDCOMMENTS,
+    0, 0, 0, 0,
+    DSC_KW_BEGINPAGESETUP, 0, 0, 0,
+    0, 0, 0, 0,
+    0, DSC_KW_DOCUMENTMEDIA, 0, 0,
+    0, 0, 0, DSC_KW_PAGETRAILER,
+    0, DSC_KW_DOCUMENTPAPERFORMS, 0, 0,
+    DSC_KW_ENDFEATURE, 0, 0, 0,
+    DSC_KW_ENDPROLOG, DSC_KW_LANGUAGELEVEL, 0, DSC_KW_TRAILER,
+    0, 0, DSC_KW_PAGE, 0,
+    0, 0, 0, 0,
+    0, 0, 0, 0,
+    0, 0, 0, 0,
+    0, DSC_KW_CROPBOX, 0, 0,
+    DSC_KW_BEGINPROCSET, 0, 0, 0,
+    0, 0, DSC_KW_ENDPROCSET, DSC_KW_INCLUDEFONT,
+    0, 0, 0, 0,
+    0, 0, 0, 0,
+    0, DSC_KW_ENDFONT, 0, 0,
+    0, DSC_KW_ENDPAGESETUP, 0, DSC_KW_DOCUMENTPAPERWEIGHTS,
+    0, 0, 0, 0,
+    0, DSC_KW_HIRESBOUNDINGBOX, DSC_KW_PAGEMEDIA, 0,
+    0, 0, DSC_KW_DOCUMENTPAPERCOLORS, DSC_KW_BOUNDINGBOX,
+    0, 0, 0, 0,
+};
+
 /******************************************************************/
 /* Public functions                                               */
 /******************************************************************/
@@ -302,6 +518,7 @@ dsc_scan_data(CDSC *dsc, const char *data, int length)
 {
     int bytes_read;
     int code = 0;
+    int photoshop;
 
     if (dsc == NULL)
 	return CDSC_ERROR;
@@ -349,6 +566,7 @@ dsc_scan_data(CDSC *dsc, const char *data, int length)
 		break;
 	    }
 	    dsc->id = code;
+	    dsc_comment(dsc);
 	}
 
         if (code == CDSC_NOTDSC) {
@@ -370,17 +588,16 @@ dsc_scan_data(CDSC *dsc, const char *data, int length)
 		continue;	/* embedded document */
 	    if (dsc->skip_lines)
 		continue;	/* embedded lines */
-	    if (IS_DSC(dsc->line, "%%BeginData:"))
-		continue;
-	    if (IS_DSC(dsc->line, "%%BeginBinary:"))
-		continue;
-	    if (IS_DSC(dsc->line, "%%EndDocument"))
-		continue;
-	    if (IS_DSC(dsc->line, "%%EndData"))
-		continue;
-	    if (IS_DSC(dsc->line, "%%EndBinary"))
-		continue;
+	    switch (dsc->keyword) {
+		case DSC_KW_BEGINDATA:
+		case DSC_KW_BEGINBINARY:
+		case DSC_KW_ENDDOCUMENT:
+		case DSC_KW_ENDDATA:
+		case DSC_KW_ENDBINARY:
+		    continue;
+	    }
 
+	    photoshop = dsc_scan_photoshop(dsc);
 	    do {
 		switch (dsc->scan_section) {
 		    case scan_comments:
@@ -419,6 +636,9 @@ dsc_scan_data(CDSC *dsc, const char *data, int length)
 		}
 		/* repeat if line is start of next section */
 	    } while (code == CDSC_PROPAGATE);
+	    if (photoshop)
+		dsc->id = photoshop;
+	    dsc_comment(dsc);
 
 	    /* if DOS EPS header not complete, ask for more */
 	    if (code == CDSC_NEEDMORE) {
@@ -435,6 +655,51 @@ dsc_scan_data(CDSC *dsc, const char *data, int length)
     return (code < 0) ? code : dsc->id;
 }
 
+/* Process a buffer taken from the end of the document */
+/* Return value is < 0 for error, >=0 for OK, as for dsc_scan_data() */
+int
+dsc_scan_trailer_data(CDSC *dsc, unsigned long offset, const char *data, 
+    int length)
+{
+    int i;
+    int code;
+
+    if (dsc == NULL)
+	return CDSC_ERROR;
+
+    if ((dsc->id == CDSC_NOTDSC) || (dsc->scan_section == scan_none))
+	return CDSC_NOTDSC;
+
+    /* find the last %%Trailer at the start of a line */
+    for (i = length - 9; i >= 0; i--) {
+	if ((data[i] == '%') && COMPARE(data+i, "%%Trailer") &&
+	    ((i == 0) || IS_EOL(data[i-1])))
+	    break;
+    }
+    if (i < 0)
+	return CDSC_OK;	/* no trailer in this buffer */
+
+    /* discard anything left over from the header */
+    dsc->data_length = 0;
+    dsc->data_index = 0;
+    dsc->data_offset = offset + i;
+    dsc->eof = FALSE;
+    dsc->line = NULL;
+    dsc->line_length = 0;
+    dsc->eol = FALSE;
+    dsc->last_cr = FALSE;
+    dsc->skip_document = 0;
+    dsc->skip_bytes = 0;
+    dsc->skip_lines = 0;
+    dsc->scan_section = scan_pre_trailer;
+
+    code = dsc_scan_data(dsc, data + i, length - i);
+    /* make sure that an unterminated last line is processed */
+    if ((code >= 0) && (length > i) && !IS_EOL(data[length-1]))
+	code = dsc_scan_data(dsc, "\n", 1);
+    return code;
+}
+
 /* Tidy up from incorrect DSC comments */
 int 
 dsc_fixup(CDSC *dsc)
@@ -577,6 +842,16 @@ dsc_set_error_function(CDSC *dsc,
 }
 
 
+/* Install a function to be called for each DSC comment found. */
+/* This is optional */
+void 
+dsc_set_comment_function(CDSC *dsc, 
+	void (*fn)(P4(void *caller_data, CDSC *dsc, 
+	int id, unsigned long offset)))
+{
+    dsc->dsc_comment_fn = fn;
+}
+
 /* Install a function for printing debug messages */
 /* This is optional */
 void 
@@ -791,6 +1066,9 @@ dsc_reset(CDSC *dsc)
     dsc->endsetup = 0;
     dsc->begintrailer = 0;
     dsc->endtrailer = 0;
+    dsc->beginimagedata = 0;
+    dsc->beginphotoshop = 0;
+    dsc->endphotoshop = 0;
 	
     for (i=0; i<dsc->page_count; i++) {
 	/* page media is pointer to an element of media or dsc_known_media */
@@ -899,6 +1177,7 @@ dsc_reset(CDSC *dsc)
     if (dsc->crop_box)
 	dsc_memfree(dsc, dsc->crop_box);
     dsc->crop_box = NULL;
+    dsc->atend = 0;
 }
 
 /* 
@@ -919,6 +1198,19 @@ dsc_section_join(unsigned long begin, unsigned long *pend, unsigned long **pplas
 }
 
 
+/* Return pointer to the first \r or \n in line, or last if there is none.
+ * memchr() is used for the search because the C library vectorises it,
+ * which matters when scanning megabytes of PostScript code.
+ */
+dsc_private char *
+dsc_find_eol(char *line, char *last)
+{
+    char *lf = (char *)memchr(line, '\n', last - line);
+    char *end = lf ? lf : last;
+    char *cr = (char *)memchr(line, '\r', end - line);
+    return cr ? cr : end;
+}
+
 /* return value is 0 if no line available, or length of line */
 dsc_private int
 dsc_read_line(CDSC *dsc)
@@ -967,24 +1259,20 @@ dsc_read_line(CDSC *dsc)
 
 	/* look for EOL */
 	dsc->eol = FALSE;
-	for (p = dsc->line; p < last; p++) {
+	p = dsc_find_eol(dsc->line, last);
+	if (memchr(dsc->line, '\032', p - dsc->line) != NULL)
+	    dsc->eol = TRUE;		/* MS-DOS Ctrl+Z */
+	if (p < last) {
 	    if (*p == '\r') {
 		p++;
 		if ((p<last) && (*p == '\n'))
 		    p++;	/* include line feed also */
 		else
 		    dsc->last_cr = TRUE; /* we might need to skip \n */
-		dsc->eol = TRUE;	/* dsc->line is a complete line */
-		break;
-	    }
-	    if (*p == '\n') {
-		p++;
-		dsc->eol = TRUE;	/* dsc->line is a complete line */
-		break;
-	    }
-	    if (*p == '\032') {		/* MS-DOS Ctrl+Z */
-		dsc->eol = TRUE;
 	    }
+	    else
+		p++;		/* include line feed */
+	    dsc->eol = TRUE;	/* dsc->line is a complete line */
 	}
 	if (dsc->eol == FALSE) {
 	    /* we haven't got a complete line yet */
@@ -1000,15 +1288,16 @@ dsc_read_line(CDSC *dsc)
     if (dsc->line_length == 0)
 	return 0;
 	
-    if ((dsc->line[0]=='%') && (dsc->line[1]=='%'))  {
+    dsc->keyword = dsc_keyword(dsc->line, dsc->line_length);
+    if (dsc->keyword != DSC_KW_NONE) {
 	/* handle recursive %%BeginDocument */
 	if ((dsc->skip_document) && dsc->line_length &&
-		COMPARE(dsc->line, "%%EndDocument")) {
+		(dsc->keyword == DSC_KW_ENDDOCUMENT)) {
 	    dsc->skip_document--;
 	}
 
 	/* handle embedded lines or binary data */
-	if (COMPARE(dsc->line, "%%BeginData:")) {
+	if (dsc->keyword == DSC_KW_BEGINDATA) {
 	    /* %%BeginData: <numberof>[ <type> [ <bytesorlines> ] ] 
 	     * <numberof> ::= <uint> (Lines or physical bytes) 
 	     * <type> ::= Hex | Binary | ASCII (Type of data) 
@@ -1065,7 +1354,7 @@ dsc_read_line(CDSC *dsc)
 		}
 	    }
 	}
-	else if (COMPARE(dsc->line, "%%BeginBinary:")) {
+	else if (dsc->keyword == DSC_KW_BEGINBINARY) {
 	    /* byte count doesn't includes \n or \r\n or \r of %%BeginBinary:*/
 	    unsigned long cnt = atoi(dsc->line + 14);
 	    if (dsc->skip_bytes == 0) {
@@ -1075,8 +1364,7 @@ dsc_read_line(CDSC *dsc)
 	}
     }
 	
-    if ((dsc->line[0]=='%') && (dsc->line[1]=='%') &&
-	COMPARE(dsc->line, "%%BeginDocument:") ) {
+    if (dsc->keyword == DSC_KW_BEGINDOCUMENT) {
 	/* Skip over embedded document, recursively */
 	dsc->skip_document++;
     }
@@ -1090,6 +1378,14 @@ dsc_read_line(CDSC *dsc)
 }
 
 
+/* Tell the caller about the DSC comment on the line just processed */
+dsc_private void 
+dsc_comment(CDSC *dsc)
+{
+    if (dsc->dsc_comment_fn && (dsc->id >= CDSC_UNKNOWNDSC) && dsc->line)
+	dsc->dsc_comment_fn(dsc->caller_data, dsc, dsc->id, DSC_START(dsc));
+}
+
 /* Save last DSC line, for use with %%+ */
 dsc_private void 
 dsc_save_line(CDSC *dsc)
@@ -1114,26 +1410,92 @@ dsc_unknown(CDSC *dsc)
     }
 }
 
+/* Photoshop describes its raster and writes its image resources, */
+/* which hold its thumbnail, in comments of its own with a single %. */
+/* They may come in any section, so they are looked for before the */
+/* line goes to the section.  Return the id of such a comment, or 0. */
+dsc_private int
+dsc_scan_photoshop(CDSC *dsc)
+{
+    char *line = dsc->line;
+
+    if ((dsc->line_length < 13) || (line[0] != '%') || (line[1] == '%'))
+	return 0;
+    if (IS_DSC(line, "%ImageData:")) {
+	if (dsc->beginimagedata == 0)
+	    dsc->beginimagedata = DSC_START(dsc);
+	return CDSC_IMAGEDATA;
+    }
+    if (IS_DSC(line, "%BeginPhotoshop:")) {
+	if (dsc->beginphotoshop == 0)
+	    dsc->beginphotoshop = DSC_START(dsc);
+	return CDSC_BEGINPHOTOSHOP;
+    }
+    if (IS_DSC(line, "%EndPhotoshop")) {
+	if ((dsc->beginphotoshop != 0) && (dsc->endphotoshop == 0))
+	    dsc->endphotoshop = DSC_END(dsc);
+	return CDSC_ENDPHOTOSHOP;
+    }
+    return 0;
+}
+
+/* remember that a header comment was deferred to the trailer */
+dsc_private void 
+dsc_mark_atend(CDSC *dsc, unsigned int flag)
+{
+    if (dsc->scan_section == scan_comments)
+	dsc->atend |= flag;
+}
+
+
+/* Identify the DSC keyword at the start of line, without comparing */
+/* the line against every keyword in turn.  Like IS_DSC(), a keyword */
+/* matches any line which starts with it, so the line is hashed one */
+/* character at a time and each prefix is looked up in turn.  At most */
+/* one prefix can match, because no keyword is a prefix of another. */
+dsc_private int
+dsc_keyword(const char *line, unsigned int length)
+{
+    const char *p = line + 2;
+    GSDWORD hash = DSC_KEYWORD_SEED;
+    unsigned int i;
+    int keyword;
+    char ch;
+
+    if ((length < 3) || (line[0] != '%') || (line[1] != '%'))
+	return DSC_KW_NONE;
+    length -= 2;
+    if (length > DSC_KEYWORD_MAX)
+	length = DSC_KEYWORD_MAX;
+
+    for (i = 1; i <= length; i++) {
+	ch = p[i-1];
+	if (IS_WHITE_OR_EOL(ch) || (ch == '\0'))
+	    break;
+	hash = ((hash ^ (unsigned char)ch) * 16777619UL) & 0xffffffffUL;
+	keyword = dsc_keyword_slot[hash >> 24];
+	if (keyword && (dsc_keywords[keyword].length == i) &&
+	    (memcmp(p, dsc_keywords[keyword].name, i) == 0))
+	    return keyword;
+	if (ch == ':')
+	    break;	/* keywords end at the colon */
+    }
+    return DSC_KW_NONE;
+}
 
 dsc_private GSBOOL
-dsc_is_section(char *line)
+dsc_is_section(int keyword)
 {
-    if ( !((line[0]=='%') && (line[1]=='%')) )
-	return FALSE;
-    if (IS_DSC(line, "%%BeginPreview"))
-	return TRUE;
-    if (IS_DSC(line, "%%BeginDefaults"))
-	return TRUE;
-    if (IS_DSC(line, "%%BeginProlog"))
-	return TRUE;
-    if (IS_DSC(line, "%%BeginSetup"))
-	return TRUE;
-    if (IS_DSC(line, "%%Page:"))
-	return TRUE;
-    if (IS_DSC(line, "%%Trailer"))
-	return TRUE;
-    if (IS_DSC(line, "%%EOF"))
-	return TRUE;
+    switch (keyword) {
+	case DSC_KW_BEGINPREVIEW:
+	case DSC_KW_BEGINDEFAULTS:
+	case DSC_KW_BEGINPROLOG:
+	case DSC_KW_BEGINSETUP:
+	case DSC_KW_PAGE:
+	case DSC_KW_TRAILER:
+	case DSC_KW_EOF:
+	    return TRUE;
+    }
     return FALSE;
 }
 
@@ -1223,7 +1585,7 @@ dsc_parse_pages(CDSC *dsc)
 	}
     }
 
-    n = IS_DSC(dsc->line, "%%+") ? 3 : 8;
+    n = (dsc->keyword == DSC_KW_CONTINUED) ? 3 : 8;
     while (IS_WHITE(dsc->line[n]))
 	n++;
     p = dsc->line + n;
@@ -1232,7 +1594,7 @@ dsc_parse_pages(CDSC *dsc)
 	switch (rc) {
 	    case CDSC_RESPONSE_OK:
 		/* assume (atend) */
-		/* we should mark it as deferred */
+		dsc_mark_atend(dsc, CDSC_ATEND_PAGES);
 		break;
 	    case CDSC_RESPONSE_CANCEL:
 		/* ignore it */
@@ -1242,8 +1604,7 @@ dsc_parse_pages(CDSC *dsc)
 	}
     }
     else if (COMPARE(p, "(atend)")) {
-	/* do nothing */
-	/* we should mark it as deferred */
+	dsc_mark_atend(dsc, CDSC_ATEND_PAGES);
     }
     else {
 	ip = dsc_get_int(dsc->line+n, dsc->line_length-n, &i);
@@ -1342,7 +1703,8 @@ dsc_parse_bounding_box(CDSC *dsc, CDSCBBOX** pbbox, int offset)
 	switch (rc) {
 	    case CDSC_RESPONSE_OK:
 		/* assume (atend) */
-		/* we should mark it as deferred */
+		if (pbbox == &dsc->bbox)
+		    dsc_mark_atend(dsc, CDSC_ATEND_BOUNDINGBOX);
 		break;
 	    case CDSC_RESPONSE_CANCEL:
 		/* ignore it */
@@ -1352,8 +1714,8 @@ dsc_parse_bounding_box(CDSC *dsc, CDSCBBOX** pbbox, int offset)
 	}
     }
     else if (COMPARE(p, "(atend)")) {
-	/* do nothing */
-	/* we should mark it as deferred */
+	if (pbbox == &dsc->bbox)
+	    dsc_mark_atend(dsc, CDSC_ATEND_BOUNDINGBOX);
     }
     else {
         /* llx = */ lly = urx = ury = 0;
@@ -1550,7 +1912,8 @@ dsc_parse_orientation(CDSC *dsc, unsigned int *porientation, int offset)
 	switch (rc) {
 	    case CDSC_RESPONSE_OK:
 		/* assume (atend) */
-		/* we should mark it as deferred */
+		if (porientation == &dsc->page_orientation)
+		    dsc_mark_atend(dsc, CDSC_ATEND_ORIENTATION);
 		break;
 	    case CDSC_RESPONSE_CANCEL:
 		/* ignore it */
@@ -1560,8 +1923,8 @@ dsc_parse_orientation(CDSC *dsc, unsigned int *porientation, int offset)
 	}
     }
     else if (COMPARE(p, "(atend)")) {
-	/* do nothing */
-	/* we should mark it as deferred */
+	if (porientation == &dsc->page_orientation)
+	    dsc_mark_atend(dsc, CDSC_ATEND_ORIENTATION);
     }
     else if (COMPARE(p, "Portrait")) {
 	*porientation = CDSC_PORTRAIT;
@@ -1604,7 +1967,7 @@ dsc_parse_order(CDSC *dsc)
 	}
     }
 
-    p = dsc->line + (IS_DSC(dsc->line, "%%+") ? 3 : 13);
+    p = dsc->line + ((dsc->keyword == DSC_KW_CONTINUED) ? 3 : 13);
     while (IS_WHITE(*p))
 	p++;
     if (COMPARE(p, "atend")) {
@@ -1613,7 +1976,7 @@ dsc_parse_order(CDSC *dsc)
 	switch (rc) {
 	    case CDSC_RESPONSE_OK:
 		/* assume (atend) */
-		/* we should mark it as deferred */
+		dsc_mark_atend(dsc, CDSC_ATEND_PAGEORDER);
 		break;
 	    case CDSC_RESPONSE_CANCEL:
 		/* ignore it */
@@ -1623,8 +1986,7 @@ dsc_parse_order(CDSC *dsc)
 	}
     }
     else if (COMPARE(p, "(atend)")) {
-	/* do nothing */
-	/* we should mark it as deferred */
+	dsc_mark_atend(dsc, CDSC_ATEND_PAGEORDER);
     }
     else if (COMPARE(p, "Ascend")) {
 	dsc->page_order = CDSC_ASCEND;
@@ -1646,7 +2008,7 @@ dsc_private int
 dsc_parse_media(CDSC *dsc, const CDSCMEDIA **page_media)
 {
     char media_name[MAXSTR];
-    int n = IS_DSC(dsc->line, "%%+") ? 3 : 12; /* %%PageMedia: */
+    int n = (dsc->keyword == DSC_KW_CONTINUED) ? 3 : 12; /* %%PageMedia: */
     unsigned int i;
 
     if (dsc_copy_string(media_name, sizeof(media_name)-1,
@@ -1672,9 +2034,9 @@ dsc_parse_document_media(CDSC *dsc)
     CDSCMEDIA lmedia;
     GSBOOL blank_line;
 
-    if (IS_DSC(dsc->line, "%%DocumentMedia:"))
+    if (dsc->keyword == DSC_KW_DOCUMENTMEDIA)
 	n = 16;
-    else if (IS_DSC(dsc->line, "%%+"))
+    else if (dsc->keyword == DSC_KW_CONTINUED)
 	n = 3;
     else
 	return CDSC_ERROR;	/* error */
@@ -1739,7 +2101,7 @@ dsc_parse_viewing_orientation(CDSC *dsc, CDSCCTM **pctm)
 	*pctm = NULL;
     }
 
-    n = IS_DSC(dsc->line, "%%+") ? 3 : 21;  /* %%ViewingOrientation: */
+    n = (dsc->keyword == DSC_KW_CONTINUED) ? 3 : 21;  /* %%ViewingOrientation: */
     while (IS_WHITE(dsc->line[n]))
 	n++;
 
@@ -1921,19 +2283,20 @@ dsc_scan_comments(CDSC *dsc)
     /* Save a few important lines */
 
     char *line = dsc->line;
+    int keyword = dsc->keyword;
     GSBOOL continued = FALSE;
     dsc->id = CDSC_OK;
-    if (IS_DSC(line, "%%EndComments")) {
+    if (keyword == DSC_KW_ENDCOMMENTS) {
 	dsc->id = CDSC_ENDCOMMENTS;
 	dsc->endcomments = DSC_END(dsc);
 	dsc->scan_section = scan_pre_preview;
 	return CDSC_OK;
     }
-    else if (IS_DSC(line, "%%BeginComments")) {
+    else if (keyword == DSC_KW_BEGINCOMMENTS) {
 	/* ignore because we are in this section */
 	dsc->id = CDSC_BEGINCOMMENTS;
     }
-    else if (dsc_is_section(line)) {
+    else if (dsc_is_section(keyword)) {
 	dsc->endcomments = DSC_START(dsc);
 	dsc->scan_section = scan_pre_preview;
 	return CDSC_PROPAGATE;
@@ -1963,43 +2326,44 @@ dsc_scan_comments(CDSC *dsc)
      * is valid for the DSC comments understood by this parser
      * for all documents that we have seen.
      */
-    if (IS_DSC(line, "%%+")) {
+    if (keyword == DSC_KW_CONTINUED) {
 	line = dsc->last_line;
+	keyword = dsc_keyword(line, sizeof(dsc->last_line));
 	continued = TRUE;
     }
     else
 	dsc_save_line(dsc);
 
-    if (IS_DSC(line, "%%Pages:")) {
+    if (keyword == DSC_KW_PAGES) {
 	dsc->id = CDSC_PAGES;
 	if (dsc_parse_pages(dsc) != 0)
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%Creator:")) {
+    else if (keyword == DSC_KW_CREATOR) {
 	dsc->id = CDSC_CREATOR;
 	dsc->dsc_creator = dsc_add_line(dsc, dsc->line+10, dsc->line_length-10);
 	if (dsc->dsc_creator==NULL)
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%CreationDate:")) {
+    else if (keyword == DSC_KW_CREATIONDATE) {
 	dsc->id = CDSC_CREATIONDATE;
 	dsc->dsc_date = dsc_add_line(dsc, dsc->line+15, dsc->line_length-15);
 	if (dsc->dsc_date==NULL)
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%Title:")) {
+    else if (keyword == DSC_KW_TITLE) {
 	dsc->id = CDSC_TITLE;
 	dsc->dsc_title = dsc_add_line(dsc, dsc->line+8, dsc->line_length-8);
 	if (dsc->dsc_title==NULL)
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%For:")) {
+    else if (keyword == DSC_KW_FOR) {
 	dsc->id = CDSC_FOR;
 	dsc->dsc_for = dsc_add_line(dsc, dsc->line+6, dsc->line_length-6);
 	if (dsc->dsc_for==NULL)
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%LanguageLevel:")) {
+    else if (keyword == DSC_KW_LANGUAGELEVEL) {
 	unsigned int n = continued ? 3 : 16;
 	unsigned int i;
 	int ll;
@@ -2015,40 +2379,40 @@ dsc_scan_comments(CDSC *dsc)
 	else 
 	    dsc_unknown(dsc);
     }
-    else if (IS_DSC(line, "%%BoundingBox:")) {
+    else if (keyword == DSC_KW_BOUNDINGBOX) {
 	dsc->id = CDSC_BOUNDINGBOX;
 	if (dsc_parse_bounding_box(dsc, &(dsc->bbox), continued ? 3 : 14))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%HiResBoundingBox:")) {
+    else if (keyword == DSC_KW_HIRESBOUNDINGBOX) {
 	dsc->id = CDSC_HIRESBOUNDINGBOX;
 	if (dsc_parse_float_bounding_box(dsc, &(dsc->hires_bbox), 
 	    continued ? 3 : 19))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%CropBox:")) {
+    else if (keyword == DSC_KW_CROPBOX) {
 	dsc->id = CDSC_CROPBOX;
 	if (dsc_parse_float_bounding_box(dsc, &(dsc->crop_box), 
 	    continued ? 3 : 10))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%Orientation:")) {
+    else if (keyword == DSC_KW_ORIENTATION) {
 	dsc->id = CDSC_ORIENTATION;
 	if (dsc_parse_orientation(dsc, &(dsc->page_orientation), 
 		continued ? 3 : 14))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%PageOrder:")) {
+    else if (keyword == DSC_KW_PAGEORDER) {
 	dsc->id = CDSC_PAGEORDER;
 	if (dsc_parse_order(dsc))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%DocumentMedia:")) {
+    else if (keyword == DSC_KW_DOCUMENTMEDIA) {
 	dsc->id = CDSC_DOCUMENTMEDIA;
 	if (dsc_parse_document_media(dsc))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%DocumentPaperSizes:")) {
+    else if (keyword == DSC_KW_DOCUMENTPAPERSIZES) {
 	/* DSC 2.1 */
 	unsigned int n = continued ? 3 : 21;
 	unsigned int count = 0;
@@ -2091,7 +2455,7 @@ dsc_scan_comments(CDSC *dsc)
 	    count++;
 	}
     }
-    else if (IS_DSC(line, "%%DocumentPaperForms:")) {
+    else if (keyword == DSC_KW_DOCUMENTPAPERFORMS) {
 	/* DSC 2.1 */
 	unsigned int n = continued ? 3 : 21;
 	unsigned int count = 0;
@@ -2124,7 +2488,7 @@ dsc_scan_comments(CDSC *dsc)
 	    count++;
 	}
     }
-    else if (IS_DSC(line, "%%DocumentPaperColors:")) {
+    else if (keyword == DSC_KW_DOCUMENTPAPERCOLORS) {
 	/* DSC 2.1 */
 	unsigned int n = continued ? 3 : 22;
 	unsigned int count = 0;
@@ -2160,7 +2524,7 @@ dsc_scan_comments(CDSC *dsc)
 	    count++;
 	}
     }
-    else if (IS_DSC(line, "%%DocumentPaperWeights:")) {
+    else if (keyword == DSC_KW_DOCUMENTPAPERWEIGHTS) {
 	/* DSC 2.1 */
 	unsigned int n = continued ? 3 : 23;
 	unsigned int count = 0;
@@ -2190,7 +2554,7 @@ dsc_scan_comments(CDSC *dsc)
 	    count++;
 	}
     }
-    else if (IS_DSC(line, "%%DocumentData:")) {
+    else if (keyword == DSC_KW_DOCUMENTDATA) {
 	unsigned int n = continued ? 3 : 15;
 	char *p = dsc->line + n;
         while (IS_WHITE(*p))
@@ -2205,15 +2569,15 @@ dsc_scan_comments(CDSC *dsc)
 	else
 	    dsc_unknown(dsc);
     }
-    else if (IS_DSC(line, "%%Requirements:")) {
+    else if (keyword == DSC_KW_REQUIREMENTS) {
 	dsc->id = CDSC_REQUIREMENTS;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%DocumentNeededFonts:")) {
+    else if (keyword == DSC_KW_DOCUMENTNEEDEDFONTS) {
 	dsc->id = CDSC_DOCUMENTNEEDEDFONTS;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%DocumentSuppliedFonts:")) {
+    else if (keyword == DSC_KW_DOCUMENTSUPPLIEDFONTS) {
 	dsc->id = CDSC_DOCUMENTSUPPLIEDFONTS;
 	/* ignore */
     }
@@ -2239,12 +2603,13 @@ dsc_scan_preview(CDSC *dsc)
     /*  another section */
     /* Preview section must start with %%BeginPreview */
     char *line = dsc->line;
+    int keyword = dsc->keyword;
     dsc->id = CDSC_OK;
 
     if (dsc->scan_section == scan_pre_preview) {
 	if (IS_BLANK(line))
 	    return CDSC_OK;	/* ignore blank lines before preview */
-	else if (IS_DSC(line, "%%BeginPreview")) {
+	else if (keyword == DSC_KW_BEGINPREVIEW) {
 	    dsc->id = CDSC_BEGINPREVIEW;
 	    dsc->beginpreview = DSC_START(dsc);
 	    dsc->endpreview = DSC_END(dsc);
@@ -2260,15 +2625,15 @@ dsc_scan_preview(CDSC *dsc)
 	}
     }
 
-    if (IS_DSC(line, "%%BeginPreview")) {
+    if (keyword == DSC_KW_BEGINPREVIEW) {
 	/* ignore because we are in this section */
     }
-    else if (dsc_is_section(line)) {
+    else if (dsc_is_section(keyword)) {
 	dsc->endpreview = DSC_START(dsc);
 	dsc->scan_section = scan_pre_defaults;
 	return CDSC_PROPAGATE;
     }
-    else if (IS_DSC(line, "%%EndPreview")) {
+    else if (keyword == DSC_KW_ENDPREVIEW) {
 	dsc->id = CDSC_ENDPREVIEW;
 	dsc->endpreview = DSC_END(dsc);
 	dsc->scan_section = scan_pre_defaults;
@@ -2295,12 +2660,13 @@ dsc_scan_defaults(CDSC *dsc)
     /*  another section */
     /* Defaults section must start with %%BeginDefaults */
     char *line = dsc->line;
+    int keyword = dsc->keyword;
     dsc->id = CDSC_OK;
 
     if (dsc->scan_section == scan_pre_defaults) {
 	if (IS_BLANK(line))
 	    return CDSC_OK;	/* ignore blank lines before defaults */
-	else if (IS_DSC(line, "%%BeginDefaults")) {
+	else if (keyword == DSC_KW_BEGINDEFAULTS) {
 	    dsc->id = CDSC_BEGINDEFAULTS;
 	    dsc->begindefaults = DSC_START(dsc);
 	    dsc->enddefaults = DSC_END(dsc);
@@ -2316,39 +2682,39 @@ dsc_scan_defaults(CDSC *dsc)
     if (NOT_DSC_LINE(line)) {
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%BeginPreview")) {
+    else if (keyword == DSC_KW_BEGINPREVIEW) {
 	/* ignore because we have already processed this section */
     }
-    else if (IS_DSC(line, "%%BeginDefaults")) {
+    else if (keyword == DSC_KW_BEGINDEFAULTS) {
 	/* ignore because we are in this section */
     }
-    else if (dsc_is_section(line)) {
+    else if (dsc_is_section(keyword)) {
 	dsc->enddefaults = DSC_START(dsc);
 	dsc->scan_section = scan_pre_prolog;
 	return CDSC_PROPAGATE;
     }
-    else if (IS_DSC(line, "%%EndDefaults")) {
+    else if (keyword == DSC_KW_ENDDEFAULTS) {
 	dsc->id = CDSC_ENDDEFAULTS;
 	dsc->enddefaults = DSC_END(dsc);
 	dsc->scan_section = scan_pre_prolog;
 	return CDSC_OK;
     }
-    else if (IS_DSC(line, "%%PageMedia:")) {
+    else if (keyword == DSC_KW_PAGEMEDIA) {
 	dsc->id = CDSC_PAGEMEDIA;
 	dsc_parse_media(dsc, &dsc->page_media);
     }
-    else if (IS_DSC(line, "%%PageOrientation:")) {
+    else if (keyword == DSC_KW_PAGEORIENTATION) {
 	dsc->id = CDSC_PAGEORIENTATION;
 	/* This can override %%Orientation:  */
 	if (dsc_parse_orientation(dsc, &(dsc->page_orientation), 18))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%PageBoundingBox:")) {
+    else if (keyword == DSC_KW_PAGEBOUNDINGBOX) {
 	dsc->id = CDSC_PAGEBOUNDINGBOX;
 	if (dsc_parse_bounding_box(dsc, &(dsc->page_bbox), 18))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%ViewingOrientation:")) {
+    else if (keyword == DSC_KW_VIEWINGORIENTATION) {
 	dsc->id = CDSC_VIEWINGORIENTATION;
 	if (dsc_parse_viewing_orientation(dsc, &dsc->viewing_orientation))
 	    return CDSC_ERROR;
@@ -2423,10 +2789,11 @@ dsc_scan_prolog(CDSC *dsc)
     /*  another section */
     /* Prolog section may start with %%BeginProlog or non-dsc line */
     char *line = dsc->line;
+    int keyword = dsc->keyword;
     dsc->id = CDSC_OK;
 
     if (dsc->scan_section == scan_pre_prolog) {
-        if (dsc_is_section(line) && (!IS_DSC(line, "%%BeginProlog"))) {
+        if (dsc_is_section(keyword) && (keyword != DSC_KW_BEGINPROLOG)) {
 	    dsc->scan_section = scan_pre_setup;
 	    return CDSC_PROPAGATE;
 	}
@@ -2434,30 +2801,30 @@ dsc_scan_prolog(CDSC *dsc)
 	dsc->beginprolog = DSC_START(dsc);
 	dsc->endprolog = DSC_END(dsc);
 	dsc->scan_section = scan_prolog;
-	if (IS_DSC(line, "%%BeginProlog"))
+	if (keyword == DSC_KW_BEGINPROLOG)
 	    return CDSC_OK;
     }
    
     if (NOT_DSC_LINE(line)) {
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%BeginPreview")) {
+    else if (keyword == DSC_KW_BEGINPREVIEW) {
 	/* ignore because we have already processed this section */
     }
-    else if (IS_DSC(line, "%%BeginDefaults")) {
+    else if (keyword == DSC_KW_BEGINDEFAULTS) {
 	/* ignore because we have already processed this section */
     }
-    else if (IS_DSC(line, "%%BeginProlog")) {
+    else if (keyword == DSC_KW_BEGINPROLOG) {
 	/* ignore because we are in this section */
     }
-    else if (dsc_is_section(line)) {
+    else if (dsc_is_section(keyword)) {
 	dsc->endprolog = DSC_START(dsc);
 	dsc->scan_section = scan_pre_setup;
 	if (dsc_check_match(dsc))
 	    return CDSC_NOTDSC;
 	return CDSC_PROPAGATE;
     }
-    else if (IS_DSC(line, "%%EndProlog")) {
+    else if (keyword == DSC_KW_ENDPROLOG) {
 	dsc->id = CDSC_ENDPROLOG;
 	dsc->endprolog = DSC_END(dsc);
 	dsc->scan_section = scan_pre_setup;
@@ -2465,43 +2832,43 @@ dsc_scan_prolog(CDSC *dsc)
 	    return CDSC_NOTDSC;
 	return CDSC_OK;
     }
-    else if (IS_DSC(line, "%%BeginFont:")) {
+    else if (keyword == DSC_KW_BEGINFONT) {
 	dsc->id = CDSC_BEGINFONT;
 	/* ignore Begin/EndFont, apart form making sure */
 	/* that they are matched. */
 	dsc->begin_font_count++;
     }
-    else if (IS_DSC(line, "%%EndFont")) {
+    else if (keyword == DSC_KW_ENDFONT) {
 	dsc->id = CDSC_ENDFONT;
 	dsc->begin_font_count--;
     }
-    else if (IS_DSC(line, "%%BeginFeature:")) {
+    else if (keyword == DSC_KW_BEGINFEATURE) {
 	dsc->id = CDSC_BEGINFEATURE;
 	/* ignore Begin/EndFeature, apart form making sure */
 	/* that they are matched. */
 	dsc->begin_feature_count++;
     }
-    else if (IS_DSC(line, "%%EndFeature")) {
+    else if (keyword == DSC_KW_ENDFEATURE) {
 	dsc->id = CDSC_ENDFEATURE;
 	dsc->begin_feature_count--;
     }
-    else if (IS_DSC(line, "%%BeginResource:")) {
+    else if (keyword == DSC_KW_BEGINRESOURCE) {
 	dsc->id = CDSC_BEGINRESOURCE;
 	/* ignore Begin/EndResource, apart form making sure */
 	/* that they are matched. */
 	dsc->begin_resource_count++;
     }
-    else if (IS_DSC(line, "%%EndResource")) {
+    else if (keyword == DSC_KW_ENDRESOURCE) {
 	dsc->id = CDSC_ENDRESOURCE;
 	dsc->begin_resource_count--;
     }
-    else if (IS_DSC(line, "%%BeginProcSet:")) {
+    else if (keyword == DSC_KW_BEGINPROCSET) {
 	dsc->id = CDSC_BEGINPROCSET;
 	/* ignore Begin/EndProcSet, apart form making sure */
 	/* that they are matched. */
 	dsc->begin_procset_count++;
     }
-    else if (IS_DSC(line, "%%EndProcSet")) {
+    else if (keyword == DSC_KW_ENDPROCSET) {
 	dsc->id = CDSC_ENDPROCSET;
 	dsc->begin_procset_count--;
     }
@@ -2524,12 +2891,13 @@ dsc_scan_setup(CDSC *dsc)
     /* Setup section must start with %%BeginSetup */
 
     char *line = dsc->line;
+    int keyword = dsc->keyword;
     dsc->id = CDSC_OK;
 
     if (dsc->scan_section == scan_pre_setup) {
 	if (IS_BLANK(line))
 	    return CDSC_OK;	/* ignore blank lines before setup */
-	else if (IS_DSC(line, "%%BeginSetup")) {
+	else if (keyword == DSC_KW_BEGINSETUP) {
 	    dsc->id = CDSC_BEGINSETUP;
 	    dsc->beginsetup = DSC_START(dsc);
 	    dsc->endsetup = DSC_END(dsc);
@@ -2545,26 +2913,26 @@ dsc_scan_setup(CDSC *dsc)
     if (NOT_DSC_LINE(line)) {
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%BeginPreview")) {
+    else if (keyword == DSC_KW_BEGINPREVIEW) {
 	/* ignore because we have already processed this section */
     }
-    else if (IS_DSC(line, "%%BeginDefaults")) {
+    else if (keyword == DSC_KW_BEGINDEFAULTS) {
 	/* ignore because we have already processed this section */
     }
-    else if (IS_DSC(line, "%%BeginProlog")) {
+    else if (keyword == DSC_KW_BEGINPROLOG) {
 	/* ignore because we have already processed this section */
     }
-    else if (IS_DSC(line, "%%BeginSetup")) {
+    else if (keyword == DSC_KW_BEGINSETUP) {
 	/* ignore because we are in this section */
     }
-    else if (dsc_is_section(line)) {
+    else if (dsc_is_section(keyword)) {
 	dsc->endsetup = DSC_START(dsc);
 	dsc->scan_section = scan_pre_pages;
 	if (dsc_check_match(dsc))
 	    return CDSC_NOTDSC;
 	return CDSC_PROPAGATE;
     }
-    else if (IS_DSC(line, "%%EndSetup")) {
+    else if (keyword == DSC_KW_ENDSETUP) {
 	dsc->id = CDSC_ENDSETUP;
 	dsc->endsetup = DSC_END(dsc);
 	dsc->scan_section = scan_pre_pages;
@@ -2572,43 +2940,43 @@ dsc_scan_setup(CDSC *dsc)
 	    return CDSC_NOTDSC;
 	return CDSC_OK;
     }
-    else if (IS_DSC(line, "%%BeginFeature:")) {
+    else if (keyword == DSC_KW_BEGINFEATURE) {
 	dsc->id = CDSC_BEGINFEATURE;
 	/* ignore Begin/EndFeature, apart form making sure */
 	/* that they are matched. */
 	dsc->begin_feature_count++;
     }
-    else if (IS_DSC(line, "%%EndFeature")) {
+    else if (keyword == DSC_KW_ENDFEATURE) {
 	dsc->id = CDSC_ENDFEATURE;
 	dsc->begin_feature_count--;
     }
-    else if (IS_DSC(line, "%%Feature:")) {
+    else if (keyword == DSC_KW_FEATURE) {
 	dsc->id = CDSC_FEATURE;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%BeginResource:")) {
+    else if (keyword == DSC_KW_BEGINRESOURCE) {
 	dsc->id = CDSC_BEGINRESOURCE;
 	/* ignore Begin/EndResource, apart form making sure */
 	/* that they are matched. */
 	dsc->begin_resource_count++;
     }
-    else if (IS_DSC(line, "%%EndResource")) {
+    else if (keyword == DSC_KW_ENDRESOURCE) {
 	dsc->id = CDSC_ENDRESOURCE;
 	dsc->begin_resource_count--;
     }
-    else if (IS_DSC(line, "%%PaperColor:")) {
+    else if (keyword == DSC_KW_PAPERCOLOR) {
 	dsc->id = CDSC_PAPERCOLOR;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%PaperForm:")) {
+    else if (keyword == DSC_KW_PAPERFORM) {
 	dsc->id = CDSC_PAPERFORM;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%PaperWeight:")) {
+    else if (keyword == DSC_KW_PAPERWEIGHT) {
 	dsc->id = CDSC_PAPERWEIGHT;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%PaperSize:")) {
+    else if (keyword == DSC_KW_PAPERSIZE) {
 	/* DSC 2.1 */
         GSBOOL found_media = FALSE;
 	int i;
@@ -2659,10 +3027,11 @@ dsc_scan_page(CDSC *dsc)
     /*  %%Trailer */
     /*  %%EOF */
     char *line = dsc->line;
+    int keyword = dsc->keyword;
     dsc->id = CDSC_OK;
 
     if (dsc->scan_section == scan_pre_pages) {
-	if (IS_DSC(line, "%%Page:")) {
+	if (keyword == DSC_KW_PAGE) {
 	    dsc->scan_section = scan_pages;
 	    /* fall through */
 	}
@@ -2685,7 +3054,7 @@ dsc_scan_page(CDSC *dsc)
 	    else
 		last = &dsc->begincomments;
 	    *last = DSC_START(dsc);
-	    if (IS_DSC(line, "%%Trailer") || IS_DSC(line, "%%EOF")) {
+	    if ((keyword == DSC_KW_TRAILER) || (keyword == DSC_KW_EOF)) {
 		dsc->scan_section = scan_pre_trailer;
 		return CDSC_PROPAGATE;
 	    }
@@ -2696,7 +3065,7 @@ dsc_scan_page(CDSC *dsc)
     if (NOT_DSC_LINE(line)) {
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%Page:")) {
+    else if (keyword == DSC_KW_PAGE) {
 	dsc->id = CDSC_PAGE;
 	if (dsc->page_count) {
 	    dsc->page[dsc->page_count-1].end = DSC_START(dsc);
@@ -2709,20 +3078,20 @@ dsc_scan_page(CDSC *dsc)
 
 	return CDSC_OK;
     }
-    else if (IS_DSC(line, "%%BeginPreview")) {
+    else if (keyword == DSC_KW_BEGINPREVIEW) {
 	/* ignore because we have already processed this section */
     }
-    else if (IS_DSC(line, "%%BeginDefaults")) {
+    else if (keyword == DSC_KW_BEGINDEFAULTS) {
 	/* ignore because we have already processed this section */
     }
-    else if (IS_DSC(line, "%%BeginProlog")) {
+    else if (keyword == DSC_KW_BEGINPROLOG) {
 	/* ignore because we have already processed this section */
     }
-    else if (IS_DSC(line, "%%BeginSetup")) {
+    else if (keyword == DSC_KW_BEGINSETUP) {
 	/* ignore because we have already processed this section */
     }
-    else if (dsc_is_section(line)) {
-	if (IS_DSC(line, "%%Trailer")) {
+    else if (dsc_is_section(keyword)) {
+	if (keyword == DSC_KW_TRAILER) {
 	    dsc->page[dsc->page_count-1].end = DSC_START(dsc);
 	    if (dsc->file_length) {
 		if ((!dsc->doseps && 
@@ -2759,7 +3128,7 @@ dsc_scan_page(CDSC *dsc)
 		return CDSC_PROPAGATE;
 	    }
 	}
-	else if (IS_DSC(line, "%%EOF")) {
+	else if (keyword == DSC_KW_EOF) {
 	    dsc->page[dsc->page_count-1].end = DSC_START(dsc);
 	    if (dsc->file_length) {
 		if ((DSC_END(dsc)+100 < dsc->file_length) ||
@@ -2798,35 +3167,35 @@ dsc_scan_page(CDSC *dsc)
 		return CDSC_NOTDSC;
 	}
     }
-    else if (IS_DSC(line, "%%PageTrailer")) {
+    else if (keyword == DSC_KW_PAGETRAILER) {
 	dsc->id = CDSC_PAGETRAILER;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%BeginPageSetup")) {
+    else if (keyword == DSC_KW_BEGINPAGESETUP) {
 	dsc->id = CDSC_BEGINPAGESETUP;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%EndPageSetup")) {
+    else if (keyword == DSC_KW_ENDPAGESETUP) {
 	dsc->id = CDSC_ENDPAGESETUP;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%PageMedia:")) {
+    else if (keyword == DSC_KW_PAGEMEDIA) {
 	dsc->id = CDSC_PAGEMEDIA;
 	dsc_parse_media(dsc, &(dsc->page[dsc->page_count-1].media));
     }
-    else if (IS_DSC(line, "%%PaperColor:")) {
+    else if (keyword == DSC_KW_PAPERCOLOR) {
 	dsc->id = CDSC_PAPERCOLOR;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%PaperForm:")) {
+    else if (keyword == DSC_KW_PAPERFORM) {
 	dsc->id = CDSC_PAPERFORM;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%PaperWeight:")) {
+    else if (keyword == DSC_KW_PAPERWEIGHT) {
 	dsc->id = CDSC_PAPERWEIGHT;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%PaperSize:")) {
+    else if (keyword == DSC_KW_PAPERSIZE) {
 	/* DSC 2.1 */
         GSBOOL found_media = FALSE;
 	int i;
@@ -2858,64 +3227,64 @@ dsc_scan_page(CDSC *dsc)
 		dsc_unknown(dsc);
 	}
     }
-    else if (IS_DSC(line, "%%PageOrientation:")) {
+    else if (keyword == DSC_KW_PAGEORIENTATION) {
 	dsc->id = CDSC_PAGEORIENTATION;
 	if (dsc_parse_orientation(dsc, 
 		&(dsc->page[dsc->page_count-1].orientation) ,18))
 	    return CDSC_NOTDSC;
     }
-    else if (IS_DSC(line, "%%PageBoundingBox:")) {
+    else if (keyword == DSC_KW_PAGEBOUNDINGBOX) {
 	dsc->id = CDSC_PAGEBOUNDINGBOX;
 	if (dsc_parse_bounding_box(dsc, &dsc->page[dsc->page_count-1].bbox, 18))
 	    return CDSC_NOTDSC;
     }
-    else if (IS_DSC(line, "%%ViewingOrientation:")) {
+    else if (keyword == DSC_KW_VIEWINGORIENTATION) {
 	dsc->id = CDSC_VIEWINGORIENTATION;
 	if (dsc_parse_viewing_orientation(dsc, 
 	    &dsc->page[dsc->page_count-1].viewing_orientation))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%BeginFont:")) {
+    else if (keyword == DSC_KW_BEGINFONT) {
 	dsc->id = CDSC_BEGINFONT;
 	/* ignore Begin/EndFont, apart form making sure */
 	/* that they are matched. */
 	dsc->begin_font_count++;
     }
-    else if (IS_DSC(line, "%%EndFont")) {
+    else if (keyword == DSC_KW_ENDFONT) {
 	dsc->id = CDSC_BEGINFONT;
 	dsc->begin_font_count--;
     }
-    else if (IS_DSC(line, "%%BeginFeature:")) {
+    else if (keyword == DSC_KW_BEGINFEATURE) {
 	dsc->id = CDSC_BEGINFEATURE;
 	/* ignore Begin/EndFeature, apart form making sure */
 	/* that they are matched. */
 	dsc->begin_feature_count++;
     }
-    else if (IS_DSC(line, "%%EndFeature")) {
+    else if (keyword == DSC_KW_ENDFEATURE) {
 	dsc->id = CDSC_ENDFEATURE;
 	dsc->begin_feature_count--;
     }
-    else if (IS_DSC(line, "%%BeginResource:")) {
+    else if (keyword == DSC_KW_BEGINRESOURCE) {
 	dsc->id = CDSC_BEGINRESOURCE;
 	/* ignore Begin/EndResource, apart form making sure */
 	/* that they are matched. */
 	dsc->begin_resource_count++;
     }
-    else if (IS_DSC(line, "%%EndResource")) {
+    else if (keyword == DSC_KW_ENDRESOURCE) {
 	dsc->id = CDSC_ENDRESOURCE;
 	dsc->begin_resource_count--;
     }
-    else if (IS_DSC(line, "%%BeginProcSet:")) {
+    else if (keyword == DSC_KW_BEGINPROCSET) {
 	dsc->id = CDSC_BEGINPROCSET;
 	/* ignore Begin/EndProcSet, apart form making sure */
 	/* that they are matched. */
 	dsc->begin_procset_count++;
     }
-    else if (IS_DSC(line, "%%EndProcSet")) {
+    else if (keyword == DSC_KW_ENDPROCSET) {
 	dsc->id = CDSC_ENDPROCSET;
 	dsc->begin_procset_count--;
     }
-    else if (IS_DSC(line, "%%IncludeFont:")) {
+    else if (keyword == DSC_KW_INCLUDEFONT) {
 	dsc->id = CDSC_INCLUDEFONT;
 	/* ignore */
     }
@@ -2979,18 +3348,19 @@ dsc_scan_trailer(CDSC *dsc)
     /* and ends at */
     /*  %%EOF */
     char *line = dsc->line;
+    int keyword = dsc->keyword;
     GSBOOL continued = FALSE;
     dsc->id = CDSC_OK;
 
     if (dsc->scan_section == scan_pre_trailer) {
-	if (IS_DSC(line, "%%Trailer")) {
+	if (keyword == DSC_KW_TRAILER) {
 	    dsc->id = CDSC_TRAILER;
 	    dsc->begintrailer = DSC_START(dsc);
 	    dsc->endtrailer = DSC_END(dsc);
 	    dsc->scan_section = scan_trailer;
 	    return CDSC_OK;
 	}
-	else if (IS_DSC(line, "%%EOF")) {
+	else if (keyword == DSC_KW_EOF) {
 	    dsc->id = CDSC_EOF;
 	    dsc->begintrailer = DSC_START(dsc);
 	    dsc->endtrailer = DSC_END(dsc);
@@ -3019,8 +3389,9 @@ dsc_scan_trailer(CDSC *dsc)
      * See comment above about our restrictive processing of 
      * continuation lines
      */
-    if (IS_DSC(line, "%%+")) {
+    if (keyword == DSC_KW_CONTINUED) {
 	line = dsc->last_line;
+	keyword = dsc_keyword(line, sizeof(dsc->last_line));
 	continued = TRUE;
     }
     else
@@ -3029,54 +3400,54 @@ dsc_scan_trailer(CDSC *dsc)
     if (NOT_DSC_LINE(line)) {
 	/* ignore */
     }
-    else if (IS_DSC(dsc->line, "%%EOF")) {
+    else if (dsc->keyword == DSC_KW_EOF) {
 	/* Keep scanning, in case we have a false trailer */
 	dsc->id = CDSC_EOF;
     }
-    else if (IS_DSC(dsc->line, "%%Trailer")) {
+    else if (dsc->keyword == DSC_KW_TRAILER) {
 	/* Cope with no pages with code after setup and before trailer. */
 	/* Last trailer is the correct one. */
 	dsc->id = CDSC_TRAILER;
 	dsc->begintrailer = DSC_START(dsc);
     }
-    else if (IS_DSC(line, "%%Pages:")) {
+    else if (keyword == DSC_KW_PAGES) {
 	dsc->id = CDSC_PAGES;
 	if (dsc_parse_pages(dsc) != 0)
 	       return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%BoundingBox:")) {
+    else if (keyword == DSC_KW_BOUNDINGBOX) {
 	dsc->id = CDSC_BOUNDINGBOX;
 	if (dsc_parse_bounding_box(dsc, &(dsc->bbox), continued ? 3 : 14))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%HiResBoundingBox:")) {
+    else if (keyword == DSC_KW_HIRESBOUNDINGBOX) {
 	dsc->id = CDSC_HIRESBOUNDINGBOX;
 	if (dsc_parse_float_bounding_box(dsc, &(dsc->hires_bbox), 
 	    continued ? 3 : 19))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%CropBox:")) {
+    else if (keyword == DSC_KW_CROPBOX) {
 	dsc->id = CDSC_CROPBOX;
 	if (dsc_parse_float_bounding_box(dsc, &(dsc->crop_box), 
 	    continued ? 3 : 10))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%Orientation:")) {
+    else if (keyword == DSC_KW_ORIENTATION) {
 	dsc->id = CDSC_ORIENTATION;
 	if (dsc_parse_orientation(dsc, &(dsc->page_orientation), continued ? 3 : 14))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%PageOrder:")) {
+    else if (keyword == DSC_KW_PAGEORDER) {
 	dsc->id = CDSC_PAGEORDER;
 	if (dsc_parse_order(dsc))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(line, "%%DocumentMedia:")) {
+    else if (keyword == DSC_KW_DOCUMENTMEDIA) {
 	dsc->id = CDSC_DOCUMENTMEDIA;
 	if (dsc_parse_document_media(dsc))
 	    return CDSC_ERROR;
     }
-    else if (IS_DSC(dsc->line, "%%Page:")) {
+    else if (dsc->keyword == DSC_KW_PAGE) {
 	/* This should not occur in the trailer, but we might see 
 	 * this if a document has been incorrectly embedded.
 	 */
@@ -3097,11 +3468,11 @@ dsc_scan_trailer(CDSC *dsc)
 		return CDSC_NOTDSC;
 	}
     }
-    else if (IS_DSC(line, "%%DocumentNeededFonts:")) {
+    else if (keyword == DSC_KW_DOCUMENTNEEDEDFONTS) {
 	dsc->id = CDSC_DOCUMENTNEEDEDFONTS;
 	/* ignore */
     }
-    else if (IS_DSC(line, "%%DocumentSuppliedFonts:")) {
+    else if (keyword == DSC_KW_DOCUMENTSUPPLIEDFONTS) {
 	dsc->id = CDSC_DOCUMENTSUPPLIEDFONTS;
 	/* ignore */
     }
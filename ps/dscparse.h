@@ -90,6 +90,9 @@ typedef enum {
 
 /* Any section */
   CDSC_UNKNOWNDSC	= 100,	/* DSC comment not recognised */
+  CDSC_IMAGEDATA	= 101,	/* %ImageData: */
+  CDSC_BEGINPHOTOSHOP	= 102,	/* %BeginPhotoshop: */
+  CDSC_ENDPHOTOSHOP	= 103,	/* %EndPhotoshop */
 
 /* Header section */
   CDSC_PSADOBE		= 200,	/* %!PS-Adobe- */
@@ -198,6 +201,14 @@ typedef enum {
     CDSC_SEASCAPE = 4
 } CDSC_ORIENTATION_ENUM;
 
+/* stored in dsc->atend, comments whose value was deferred to the trailer */
+typedef enum {
+    CDSC_ATEND_PAGES = 1,
+    CDSC_ATEND_BOUNDINGBOX = 2,
+    CDSC_ATEND_ORIENTATION = 4,
+    CDSC_ATEND_PAGEORDER = 8
+} CDSC_ATEND_FLAGS;
+
 /* stored in dsc->document_data */
 typedef enum {
     CDSC_DATA_UNKNOWN = 0,
@@ -340,6 +351,10 @@ struct CDSC_S {
     unsigned long endsetup;
     unsigned long begintrailer;
     unsigned long endtrailer;
+    /* Photoshop comments, 0 if not found */
+    unsigned long beginimagedata;	/* %ImageData: line */
+    unsigned long beginphotoshop;	/* first image resources block */
+    unsigned long endphotoshop;
     CDSCPAGE *page;
     unsigned int page_count;	/* number of %%Page: pages in document */
     unsigned int page_pages;	/* number of pages in document from %%Pages: */
@@ -397,6 +412,7 @@ struct CDSC_S {
     char *line;			/* pointer to last read DSC line */
 				/* not null terminated */
     unsigned int line_length; 	/* number of characters in line */
+    int keyword;		/* DSC keyword of line, or 0 */
     GSBOOL eol;			/* TRUE if dsc_line contains EOL */
     GSBOOL last_cr;		/* TRUE if last line ended in \r */
 				/* check next time for \n */
@@ -424,6 +440,14 @@ struct CDSC_S {
     /* Added 2001-10-01 */
     CDSCFBBOX *hires_bbox;	/* the hires document bounding box */
     CDSCFBBOX *crop_box;	/* the size of the trimmed page */
+
+    /* public data */
+    unsigned int atend;		/* header comments deferred with (atend) */
+				/* bitmask of CDSC_ATEND_FLAGS */
+
+    /* function called for each DSC comment found by dsc_scan_data() */
+    void (*dsc_comment_fn)(P4(void *caller_data, CDSC *dsc, 
+	int id, unsigned long offset));
 };
 
 
@@ -449,6 +473,15 @@ void dsc_set_length(P2(CDSC *dsc, unsigned long len));
 /* Process a buffer containing DSC comments and PostScript */
 int dsc_scan_data(P3(CDSC *dsc, const char *data, int len));
 
+/* Process a buffer taken from the end of the document, starting at
+ * document offset "offset".  The last %%Trailer in the buffer is
+ * parsed, so that comments deferred with (atend) are known without
+ * scanning the whole document.  Call this after the header has
+ * been processed with dsc_scan_data().
+ */
+int dsc_scan_trailer_data(P4(CDSC *dsc, unsigned long offset, 
+    const char *data, int len));
+
 /* All data has been processed, fixup any DSC errors */
 int dsc_fixup(P1(CDSC *dsc));
 
@@ -457,6 +490,12 @@ void dsc_set_error_function(P2(CDSC *dsc,
     int (*dsc_error_fn)(P5(void *caller_data, CDSC *dsc, 
 	unsigned int explanation, const char *line, unsigned int line_len))));
 
+/* Install function to be told about each DSC comment found, */
+/* with the document offset of the start of the comment line */
+void dsc_set_comment_function(P2(CDSC *dsc, 
+    void (*dsc_comment_fn)(P4(void *caller_data, CDSC *dsc, 
+	int id, unsigned long offset))));
+
 /* Install print function for debug messages */
 void dsc_set_debug_function(P2(CDSC *dsc, 
 	void (*debug_fn)(P2(void *caller_data, const char *str))));
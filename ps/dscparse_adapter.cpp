@@ -225,6 +225,21 @@ unsigned long KDSC::endtrailer() const
     return _cdsc->endtrailer;
 }
 
+unsigned long KDSC::beginimagedata() const
+{
+    return _cdsc->beginimagedata;
+}
+
+unsigned long KDSC::beginphotoshop() const
+{
+    return _cdsc->beginphotoshop;
+}
+
+unsigned long KDSC::endphotoshop() const
+{
+    return _cdsc->endphotoshop;
+}
+
 CDSCPAGE* KDSC::page() const
 {
     return _cdsc->page;
@@ -250,6 +265,11 @@ unsigned int KDSC::page_orientation() const
     return _cdsc->page_orientation;
 }
 
+unsigned int KDSC::atend() const
+{
+    return _cdsc->atend;
+}
+
 CDSCCTM* KDSC::viewing_orientation() const
 {
     return _cdsc->viewing_orientation;
@@ -311,6 +331,12 @@ bool KDSC::scanData( char* buffer, unsigned int count )
     return _scanHandler->scanData( buffer, count );
 }
 
+bool KDSC::scanTrailer( char* buffer, unsigned int count, 
+	                unsigned long offset )
+{
+    return ( dsc_scan_trailer_data( _cdsc, offset, buffer, count ) >= 0 );
+}
+
 int KDSC::fixup()
 {
     return dsc_fixup( _cdsc );
@@ -339,6 +365,7 @@ void KDSC::setCommentHandler( KDSCCommentHandler* commentHandler )
 {
     if( _commentHandler != nullptr && commentHandler == nullptr )
     {
+	dsc_set_comment_function( _cdsc, nullptr );
 	delete _scanHandler;
 	_scanHandler = new KDSCScanHandler( _cdsc );
     }
@@ -346,6 +373,7 @@ void KDSC::setCommentHandler( KDSCCommentHandler* commentHandler )
     {
 	delete _scanHandler;
 	_scanHandler = new KDSCScanHandlerByLine( _cdsc, commentHandler );
+	dsc_set_comment_function( _cdsc, &commentFunction );
     }
     _commentHandler = commentHandler;
 }
@@ -376,33 +404,35 @@ int KDSC::errorFunction( void* caller_data, CDSC* dsc,
     return kdsc->errorHandler()->error( error );
 }
 
+void KDSC::commentFunction( void* caller_data, CDSC* dsc, 
+	int id, unsigned long offset )
+{
+    Q_UNUSED( dsc );
+    
+    KDSC* kdsc = static_cast< KDSC* >( caller_data );
+    Q_ASSERT( kdsc );
+
+    kdsc->_scanHandler->queueComment( id, offset );
+}
+
 bool KDSCScanHandlerByLine::scanData( char* buf, unsigned int count )
 {
-    char* lineStart = buf;
-    char* it = buf;
-    while( it < buf + count )
-    {
-	if( *it++ == '\n' )
-	{
-	    int retval = dsc_scan_data( _cdsc, lineStart, it - lineStart );
-	    if( retval < 0 ) 
-		return false;
-	    else if( retval > 0 )
-	    {
-		_commentHandler->comment( 
-			static_cast<KDSCCommentHandler::Name>( retval ) );
-	    }
-	    lineStart = it;
-	}
-    }
-  
-    if( it != lineStart )
-    {
-	// Scan the remaining part of the string.
-	return ( dsc_scan_data( _cdsc, lineStart, it - lineStart ) < 0 );
-    }
-    else
-	return true;
+    // The parser splits the whole buffer into lines itself and reports
+    // each comment through queueComment(), so there is a single
+    // dsc_scan_data() call per buffer rather than one per line.
+    _events.clear();
+    int retval = dsc_scan_data( _cdsc, buf, count );
+
+    for( const Event& event : _events )
+	_commentHandler->commentAt( event.second, event.first );
+
+    return ( retval >= 0 );
+}
+
+void KDSCScanHandlerByLine::queueComment( int id, unsigned long offset )
+{
+    _events.push_back( 
+	    Event( offset, static_cast<KDSCCommentHandler::Name>( id ) ) );
 }
 
 // vim:sw=4:sts=4:ts=8:noet
@@ -10,6 +10,8 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <QSize>
 #include <QString>
@@ -122,6 +124,11 @@ public:
     virtual ~KDSCCommentHandler() {}
     enum Name
     {
+	// Photoshop, any section
+	ImageData             = CDSC_IMAGEDATA,
+	BeginPhotoshop        = CDSC_BEGINPHOTOSHOP,
+	EndPhotoshop          = CDSC_ENDPHOTOSHOP,
+
 	// Header section
 	PSAdobe               = CDSC_PSADOBE,
 	BeginComments         = CDSC_BEGINCOMMENTS,
@@ -204,6 +211,16 @@ public:
     };
 	
     virtual void comment( Name name ) { std::cout << name << std::endl; }
+
+    /**
+     * Called with the document offset of the start of the comment line.
+     * The default implementation forwards to comment( Name ).
+     */
+    virtual void commentAt( Name name, unsigned long offset ) 
+    { 
+	Q_UNUSED( offset );
+	comment( name ); 
+    }
 };
 
 class KDSCScanHandler;
@@ -239,12 +256,17 @@ public:
     unsigned long begintrailer()  const;
     unsigned long endtrailer()    const;
 
+    unsigned long beginimagedata() const;
+    unsigned long beginphotoshop() const;
+    unsigned long endphotoshop()   const;
+
     CDSCPAGE* page() const;
 
     unsigned int page_count()       const;
     unsigned int page_pages()       const;
     unsigned int page_order()       const;
     unsigned int page_orientation() const;
+    unsigned int atend()            const;
 
     CDSCCTM* viewing_orientation() const;
     
@@ -266,6 +288,14 @@ public:
    
     bool scanData( char*, unsigned int );
 
+    /**
+     * Scan a block taken from the end of the document, which starts at
+     * document offset @p offset, for the %%Trailer. Comments deferred
+     * with (atend) in the header are then known without reading the
+     * whole document.
+     */
+    bool scanTrailer( char*, unsigned int, unsigned long offset );
+
     /**
      * Tidy up from incorrect DSC comments.
      */
@@ -287,6 +317,8 @@ protected:
     static int errorFunction( void* caller_data, CDSC* dsc, 
                               unsigned int explanation, 
                               const char* line, unsigned int line_len );
+    static void commentFunction( void* caller_data, CDSC* dsc, 
+                                 int id, unsigned long offset );
     
 private:
     CDSC*               _cdsc;
@@ -305,6 +337,15 @@ public:
     {
 	return ( dsc_scan_data( _cdsc, buf, count ) >= 0 );
     }
+
+    /**
+     * Called by the parser for each DSC comment found while scanning.
+     */
+    virtual void queueComment( int id, unsigned long offset ) 
+    { 
+	Q_UNUSED( id ); 
+	Q_UNUSED( offset ); 
+    }
     
 protected:
     CDSC* _cdsc;
@@ -319,9 +360,13 @@ public:
     {}
     
     bool scanData( char* buf, unsigned int count ) override;
+    void queueComment( int id, unsigned long offset ) override;
 
 protected:
+    typedef std::pair< unsigned long, KDSCCommentHandler::Name > Event;
+
     KDSCCommentHandler* _commentHandler;
+    std::vector< Event > _events;
 };
 
 #endif
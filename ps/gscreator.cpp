@@ -11,29 +11,27 @@
 
     The program works as follows
 
-    1. Test if file is a DVI file
+    1. Test if the XMP metadata of a PDF or PS file, or the image
+       resources of a Photoshop EPS file, hold a thumbnail of its first
+       page, and if so use that one
 
-    2. Create a child process (1), in which the
-       file is to be changed into a PNG
+    2. Test if file is a PDF file, and if so let gs render the
+       page straight from it
 
-    3. Child-process (1) :
+    3. Otherwise test if file is a DVI file
 
-    4. If file is DVI continue with 6
+    4. If file is DVI, start dvips to turn it into PS and pipe its
+       output into gs
 
-    5. If file is no DVI continue with 9
+    5. Otherwise start gs, and write a prolog to its standard input
+       which makes it render only the first page of the file
 
-    6. Create another child process (2), in which the DVI is
-       turned into PS using dvips
+    6. Read the PNG produced by gs and store it in a QImage
 
-    7. Parent process (2) :
-       Turn the recently created PS file into a PNG file using gs
+    A file gs timed out or crashed on, or gave no image for, is not
+    rendered again for a while, see GSLimits::retryAfter.
 
-    8. continue with 10
-
-    9. Turn the PS,PDF or EPS file into a PNG file using gs
-
-    10. Parent process (1)
-        store data in a QImage
+    The processes are started and watched by GSProcess.
 */
 
 #ifdef HAVE_CONFIG_H
@@ -45,24 +43,30 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include <unistd.h>
-#include <signal.h>
-#ifdef HAVE_SYS_SELECT_H
-#include <sys/select.h>
-#endif
-#include <sys/time.h>
-#include <sys/wait.h>
-#include <fcntl.h>
-#include <errno.h>
+
+#include <memory>
 
 #include <QColor>
+#include <QDateTime>
 #include <QFile>
 #include <QImage>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QScopeGuard>
 #include <QVector>
 
 
 #include "gscreator.h"
+#include "dscindex.h"
 #include "dscparse.h"
+#include "gsprocess.h"
+#include "mipmaps.h"
+#include "pdfprefix.h"
+#include "photoshopthumbnail.h"
+#include "renderthreads.h"
+#include "trace.h"
+#include "xmpthumbnail.h"
 
 #include <KPluginFactory>
 
@@ -87,7 +91,13 @@ static const char *epsprolog =
     "0 setgray 0 setlinecap 1 setlinewidth 0 setlinejoin 10 setmiterlimit\n"
     "[ ] 0 setdash newpath false setoverprint false setstrokeadjust\n";
 
-static const char * gsargs_ps[] = {
+// Command lines for gs, which reads our prolog from standard input
+// before the document, except for PDF, and for dvips. They are built for each request,
+// as several may run at the same time.
+static QList<QByteArray> gsArgumentsPS(const QByteArray &fileName,
+                                       const QList<QByteArray> &pageSize = {})
+{
+  return QList<QByteArray> {
     "gs",
     "-sDEVICE=png16m",
     "-sOutputFile=-",
@@ -95,29 +105,56 @@ static const char * gsargs_ps[] = {
     "-dPARANOIDSAFER",
     "-dNOPAUSE",
     "-dFirstPage=1",
-    "-dLastPage=1",
+    "-dLastPage=1"
+  } + pageSize + QList<QByteArray> {
     "-q",
     "-",
-    nullptr, // file name
+    fileName,
     "-c",
     "showpage",
     "-c",
-    "quit",
-    nullptr
-};
+    "quit"
+  };
+}
+
+static QList<QByteArray> gsArgumentsPDF(const QByteArray &fileName,
+                                        unsigned int page,
+                                        const QList<QByteArray> &pageSize)
+{
+  const QByteArray pageNumber = QByteArray::number(page + 1);
+  return QList<QByteArray> {
+    "gs",
+    "-sDEVICE=png16m",
+    "-sOutputFile=-",
+    "-dSAFER",
+    "-dBATCH",
+    "-dNOPAUSE",
+    "-dFirstPage=" + pageNumber,
+    "-dLastPage=" + pageNumber,
+    // As shown on screen, annotations included
+    "-dPrinted=false"
+  } + pageSize + QList<QByteArray> {
+    "-q",
+    fileName
+  };
+}
 
-static const char * gsargs_eps[] = {
+static QList<QByteArray> gsArgumentsEPS(const QByteArray &fileName,
+                                        const QByteArray &pageSize,
+                                        const QByteArray &resolution)
+{
+  return {
     "gs",
     "-sDEVICE=png16m",
     "-sOutputFile=-",
     "-dSAFER",
     "-dPARANOIDSAFER",
     "-dNOPAUSE",
-    nullptr, // page size
-    nullptr, // resolution
+    pageSize,
+    resolution,
     "-q",
     "-",
-    nullptr, // file name
+    fileName,
     "-c",
     "pagelevel",
     "-c",
@@ -127,125 +164,337 @@ static const char * gsargs_eps[] = {
     "-c",
     "showpage",
     "-c",
-    "quit",
-    nullptr
-};
+    "quit"
+  };
+}
 
-static const char *dvipsargs[] = {
+static QList<QByteArray> dvipsArguments(const QByteArray &fileName,
+                                        unsigned int page)
+{
+  // "=" counts pages from the start of the file, whatever their \count0
+  return {
     "dvips",
+    "-p",
+    "=" + QByteArray::number(page + 1),
     "-n",
     "1",
     "-q",
     "-o",
     "-",
-    nullptr, // file name
-    nullptr
-};
+    fileName
+  };
+}
 
-static bool correctDVI(const QString& filename);
+// Recorded with failures to render a document. Bump it when a change
+// may render documents that failed before, so that they are retried.
+static const quint32 rendererVersion = 1;
 
+// How much memory, in KiB, mipmap chains of recent documents may use.
+static const int mipmapCacheSize = 64 * 1024;
+
+// How much of the end of a document is read to find a %%Trailer
+// holding comments that were deferred with (atend).
+static const long trailerReadLength = 32 * 1024;
+
+// How far past the header of Photoshop EPS files the image resources
+// are looked for
+static const unsigned long photoshopReadLength = 1024 * 1024;
+
+// How much of each end of a PDF file is searched for its page count
+static const qint64 pdfCountReadLength = 256 * 1024;
+
+static bool correctDVI(const QString& filename);
+static unsigned int dviPageCount(const QString& filename);
+static void scanPDF(FILE *fp, const QByteArray &head, DSCSummary *summary);
 
 namespace {
-	bool got_sig_term = false;
-	void handle_sigterm( int ) {
-		got_sig_term = true;
-	}
+  // Tells when the header comments are over, so that the scan can stop
+  class HeaderEndHandler : public KDSCCommentHandler
+  {
+  public:
+    bool endComments = false;
+    bool endPhotoshop = false;
+
+    // Where the page wanted, counted from 1 in file order, begins and
+    // ends, once the scan got there
+    int wantedPage = 1;
+    unsigned long pageBegin = 0;
+    unsigned long pageEnd = 0;
+    int pages = 0;
+
+    void commentAt(Name name, unsigned long offset) override
+    {
+      if (name == Page)
+        ++pages;
+      if (pageBegin && !pageEnd
+          && (name == Page || name == Trailer || name == Eof))
+        pageEnd = offset;
+      else if (name == Page && pages == wantedPage)
+        pageBegin = offset;
+      comment(name);
+    }
+
+    void comment(Name name) override
+    {
+      switch (name) {
+      case EndPreview:
+      case BeginProlog:
+      case Page:
+        endComments = true;
+        break;
+
+      case EndPhotoshop:
+        endPhotoshop = true;
+        break;
+
+      default:
+        break;
+      }
+    }
+  };
+}
+
+// The parts of the document gs needs for the page that was scanned
+// for, in order, or none if the DSC comments do not describe them
+// consistently.
+static QList<GSProcess::Range> pageRanges(const DSCSummary &summary)
+{
+  const QList<GSProcess::Range> ranges = {
+    {qint64(summary.beginProlog), qint64(summary.endProlog)},
+    {qint64(summary.beginSetup), qint64(summary.endSetup)},
+    {qint64(summary.beginPage), qint64(summary.endPage)}
+  };
+  if (ranges.last().end <= ranges.last().begin)
+    return {};
+
+  qint64 end = 0;
+  for (const GSProcess::Range &range : ranges) {
+    if (range.end <= range.begin)
+      continue; // no such section
+    if (range.begin < end)
+      return {};
+    end = range.end;
+  }
+  return ranges;
+}
+
+// Lets hover previews cycle through the pages of the document
+static KIO::ThumbnailResult withPageCount(KIO::ThumbnailResult result,
+                                          unsigned int pageCount)
+{
+  if (result.isValid() && pageCount > 1)
+    result.setSequenceIndexWraparoundPoint(pageCount);
+  return result;
 }
 
 GSCreator::GSCreator(QObject *parent, const QVariantList &args)
+  : GSCreator(parent, KPluginMetaData(), args)
+{
+}
+
+GSCreator::GSCreator(QObject *parent, const KPluginMetaData &metaData, const QVariantList &args)
   : KIO::ThumbnailCreator(parent, args)
+  , limits(GSLimits::fromConfig(metaData.rawData().value(QLatin1String("GhostscriptLimits")).toObject()))
+  , draft(GSDraftProfile::fromConfig(metaData.rawData().value(QLatin1String("GhostscriptDraft")).toObject()))
+  , threading(GSThreading::fromConfig(metaData.rawData().value(QLatin1String("GhostscriptThreads")).toObject()))
+  , dedup(QStringLiteral("gs"))
+  , sliceDocuments(qEnvironmentVariableIntValue("GSTHUMBNAIL_SLICE") > 0)
+  , mipmapSize(0)
+  , mipmapCache(mipmapCacheSize)
+{
+  // With GhostscriptMipmaps in the plugin metadata, or
+  // GSTHUMBNAIL_MIPMAPS, set to the largest thumbnail size wanted, e.g.
+  // 1024, each document is rendered once at that size and smaller sizes
+  // are taken from the resulting mipmap chain.
+  int size = metaData.rawData().value(QLatin1String("GhostscriptMipmaps")).toInt();
+  if (qEnvironmentVariableIsSet("GSTHUMBNAIL_MIPMAPS"))
+    size = qEnvironmentVariableIntValue("GSTHUMBNAIL_MIPMAPS");
+  if (size > 0)
+    mipmapSize = Mipmaps::bucketFor(size);
+}
+
+static bool sameRequest(const KIO::ThumbnailRequest &a, const KIO::ThumbnailRequest &b)
+{
+  return a.url() == b.url() && a.targetSize() == b.targetSize()
+    && a.devicePixelRatio() == b.devicePixelRatio() && a.sequenceIndex() == b.sequenceIndex();
+}
+
+void GSCreator::cancel(const KIO::ThumbnailRequest &request)
+{
+  QMutexLocker locker(&lock);
+  for (Job *job : std::as_const(jobs)) {
+    if (!sameRequest(job->request, request))
+      continue;
+    job->cancelled = true;
+    if (job->process)
+      job->process->cancel();
+  }
+}
+
+QList<QImage> GSCreator::mipmaps(const KIO::ThumbnailRequest &request)
 {
+  // The chain of the file as it is now, not of whatever was rendered last
+  DSCIndex::Key key;
+  if (!mipmapSize || !DSCIndex::fileKey(request.url().toLocalFile(), &key))
+    return {};
+  QMutexLocker locker(&lock);
+  const QList<QImage> *chain = mipmapCache.object(key);
+  return chain ? *chain : QList<QImage>();
 }
 
 KIO::ThumbnailResult GSCreator::create(const KIO::ThumbnailRequest &request)
+{
+  // Known to cancel() until we return
+  Job job{request};
+  {
+    QMutexLocker locker(&lock);
+    jobs.append(&job);
+  }
+  const auto unregister = qScopeGuard([this, &job] {
+    QMutexLocker locker(&lock);
+    jobs.removeOne(&job);
+  });
+
+  // A copy of a document rendered before, possibly under another name.
+  // Only the first page is shared.
+  const QString path = request.url().toLocalFile();
+  const bool shared = dedup.isEnabled() && request.sequenceIndex() <= 0;
+  ThumbnailDedup::Entry entry;
+  QImage image;
+  if (shared && dedup.lookup(path, request.targetSize(), &entry, &image)) {
+    KIO::ThumbnailResult result = KIO::ThumbnailResult::pass(image);
+    if (entry.wraparoundPoint > 0)
+      result.setSequenceIndexWraparoundPoint(entry.wraparoundPoint);
+    return result;
+  }
+
+  const KIO::ThumbnailResult result = render(request, &job);
+  if (shared && result.isValid()) {
+    // The page count goes with the thumbnail, a copy under another
+    // name is not in the DSC index
+    entry.wraparoundPoint = result.sequenceIndexWraparoundPoint();
+    dedup.insert(entry, result.image());
+  }
+  return result;
+}
+
+KIO::ThumbnailResult GSCreator::render(const KIO::ThumbnailRequest &request, Job *job)
 {
   const QString path = request.url().toLocalFile();
   const int width = request.targetSize().width();
   const int height = request.targetSize().height();
-// The code in the loop (when testing whether got_sig_term got set)
-// should read some variation of:
-// 		parentJob()->wasKilled()
-//
-// Unfortunatelly, that's currently impossible without breaking BIC.
-// So we need to catch the signal ourselves.
-// Otherwise, on certain funny PS files (for example
-// http://www.tjhsst.edu/~Eedanaher/pslife/life.ps )
-// gs would run forever after we were dead.
-// #### Reconsider for KDE 4 ###
-// (24/12/03 - luis_pedro)
-//
-  typedef void ( *sighandler_t )( int );
-  // according to linux's "man signal" the above typedef is a gnu extension
-  sighandler_t oldhandler = signal( SIGTERM, handle_sigterm );
-
-  int input[2];
-  int output[2];
-  int dvipipe[2];
-
-  QByteArray data(1024, '\0');
-
-  bool ok = false;
 
-  // Test if file is DVI
-  bool no_dvi =!correctDVI(request.url().toLocalFile());
+  DSCIndex::Key key;
+  const bool haveKey = DSCIndex::fileKey(path, &key);
 
-  if (pipe(input) == -1) {
-    return KIO::ThumbnailResult::fail();
-  }
-  if (pipe(output) == -1) {
-    close(input[0]);
-    close(input[1]);
+  // A document that timed out, crashed gs or gave no image is not tried
+  // again for a while, which doubles with every failure in a row
+  DSCIndex::Failure failure;
+  const bool failed = haveKey && dscIndex.lookupFailure(key, &failure) && failure.version == rendererVersion;
+  if (failed && limits.retryAfter > 0
+      && QDateTime::currentSecsSinceEpoch() < failure.time + (qint64(limits.retryAfter) << qMin(failure.count - 1, 6U)))
     return KIO::ThumbnailResult::fail();
+
+  // Repeated requests for a document, e.g. at another size, find what
+  // parsing it told us last time in the index.
+  DSCSummary summary;
+  const bool indexed = haveKey && dscIndex.isValid();
+  if (!indexed || !dscIndex.lookup(key, &summary)) {
+    TraceSpan span("gs", "dsc-scan");
+    if (!scanDocument(path, 0, &summary))
+      return KIO::ThumbnailResult::fail();
+    if (indexed)
+      dscIndex.insert(key, summary);
   }
 
-  KDSC dsc;
-  endComments = false;
-  dsc.setCommentHandler(this);
+  // Hover previews ask for the following pages by sequence index.
+  // Documents whose page count is unknown have only one.
+  const unsigned int pageCount = summary.pageCount;
+  const unsigned int page = static_cast<unsigned int>(qMax(0.0f, request.sequenceIndex())) % qMax(1U, pageCount);
+
+  // Another size of a document rendered recently, unless it was smaller
+  // than the one wanted now
+  if (mipmapSize && haveKey && page == 0) {
+    QMutexLocker locker(&lock);
+    const QList<QImage> *chain = mipmapCache.object(key);
+    if (chain && !chain->isEmpty()
+        && (chain->first().width() >= width || chain->first().height() >= height))
+      return withPageCount(KIO::ThumbnailResult::pass(Mipmaps::pick(*chain, request.targetSize())), pageCount);
+  }
 
-  if (no_dvi)
-  {
-    FILE* fp = fopen(QFile::encodeName(path), "r");
-    if (fp == nullptr) return KIO::ThumbnailResult::fail();
+  // Photoshop EPS files are mostly a raster, often of hundreds of
+  // megabytes, and come with a thumbnail of it
+  if (page == 0 && summary.endPhotoshop > summary.beginPhotoshop) {
+    TraceSpan span("gs", "photoshop-thumbnail");
+    const QImage thumbnail = PhotoshopThumbnail::fromFile(path, summary.beginPhotoshop,
+                                                          summary.endPhotoshop, request.targetSize());
+    if (!thumbnail.isNull())
+      return withPageCount(KIO::ThumbnailResult::pass(thumbnail), pageCount);
+  }
 
-    char buf[4096];
-    int count;
-    while ((count = fread(buf, sizeof(char), 4096, fp)) != 0
-           && !endComments) {
-      dsc.scanData(buf, count);
-    }
-    fclose(fp);
+  // Adobe applications store a thumbnail of the first page in the XMP
+  // metadata, which costs a base64 and JPEG decoding instead of gs.
+  if (page == 0 && !summary.dvi) {
+    TraceSpan span("gs", "xmp-thumbnail");
+    // Reading the end of the file is a seek on network file systems
+    const QImage thumbnail = summary.pdf
+      ? XMPThumbnail::fromPDF(path, !PDFPrefix::isWanted(path), request.targetSize())
+      : XMPThumbnail::fromPostScript(path, qint64(summary.beginPage), request.targetSize());
+    if (!thumbnail.isNull())
+      return withPageCount(KIO::ThumbnailResult::pass(thumbnail), pageCount);
+  }
 
-    if (dsc.pjl() || dsc.ctrld()) {
-      // this file is a mess.
+  // The index only knows where the first page of PostScript is, look
+  // for the others in the page table of the DSC comments.
+  if (page > 0 && !summary.dvi && !summary.pdf) {
+    TraceSpan span("gs", "dsc-scan");
+    if (!scanDocument(path, page, &summary))
       return KIO::ThumbnailResult::fail();
-    }
   }
 
-  std::unique_ptr<KDSCBBOX> bbox = dsc.bbox();
+  if (summary.pjl || summary.ctrld) {
+    // this file is a mess.
+    return KIO::ThumbnailResult::fail();
+  }
+
+  const bool no_dvi = !summary.dvi;
+
+  std::unique_ptr<KDSCBBOX> bbox;
+  if (summary.hasBBox)
+    bbox.reset(new KDSCBBOX(summary.llx, summary.lly, summary.urx, summary.ury));
 
-  const bool is_encapsulated = no_dvi
+  const bool is_encapsulated = no_dvi && !summary.pdf
     && (path.endsWith(QLatin1String(".eps"), Qt::CaseInsensitive)
         || path.endsWith(QLatin1String(".epsi"), Qt::CaseInsensitive))
     && bbox.get() != nullptr
     && (bbox->width() > 0)
     && (bbox->height() > 0)
-    && (dsc.page_count() <= 1);
+    && (summary.pageCount <= 1);
 
   char translation[64] = "";
   char pagesize[32] = "";
   char resopt[32] = "";
+  // Size of the page gs renders, when known
+  int gsPageWidth = 0;
+  int gsPageHeight = 0;
 
   if (is_encapsulated) {
+    // With mipmaps, render once for the largest size wanted.
+    const int renderWidth = mipmapSize ? qMax(width, mipmapSize) : width;
+    const int renderHeight = mipmapSize ? qMax(height, mipmapSize) : height;
+
     // GhostScript's rendering at the extremely low resolutions
     // required for thumbnails leaves something to be desired. To
     // get nicer images, we render to four times the required
     // resolution and let QImage scale the result.
-    const int hres = (width * 72) / bbox->width();
-    const int vres = (height * 72) / bbox->height();
+    const int hres = (renderWidth * 72) / bbox->width();
+    const int vres = (renderHeight * 72) / bbox->height();
     const int resolution = (hres > vres ? vres : hres) * 4;
     const int gswidth = ((bbox->urx() - bbox->llx()) * resolution) / 72;
     const int gsheight = ((bbox->ury() - bbox->lly()) * resolution) / 72;
 
+    gsPageWidth = gswidth;
+    gsPageHeight = gsheight;
     snprintf(pagesize, 31, "-g%ix%i", gswidth, gsheight);
     snprintf(resopt, 31, "-r%i", resolution);
     snprintf(translation, 63,
@@ -254,7 +503,7 @@ KIO::ThumbnailResult GSCreator::create(const KIO::ThumbnailRequest &request)
   }
 
   const CDSC_PREVIEW_TYPE previewType =
-    static_cast<CDSC_PREVIEW_TYPE>(dsc.preview());
+    static_cast<CDSC_PREVIEW_TYPE>(summary.preview);
 
   switch (previewType) {
   case CDSC_TIFF:
@@ -265,16 +514,17 @@ KIO::ThumbnailResult GSCreator::create(const KIO::ThumbnailRequest &request)
      break;
   case CDSC_EPSI:
     {
-      if (!bbox) {
+      if (!bbox || page > 0) {
         break;
       }
       const int xscale = bbox->width() / width;
       const int yscale = bbox->height() / height;
       const int scale = xscale < yscale ? xscale : yscale;
       if (scale == 0) break;
+      TraceSpan span("gs", "epsi-preview");
       if (auto result = getEPSIPreview(path,
-                         dsc.beginpreview(),
-                         dsc.endpreview(),
+                         summary.beginPreview,
+                         summary.endPreview,
                          bbox->width() / scale,
                          bbox->height() / scale); result.isValid())
         return result;
@@ -288,168 +538,132 @@ KIO::ThumbnailResult GSCreator::create(const KIO::ThumbnailRequest &request)
     break;
   }
 
-  pid_t pid = fork();
-  if (pid == 0) {
-    // Child process (1)
-
-    //    close(STDERR_FILENO);
-
-    // find first zero entry in gsargs and put the filename
-    // or - (stdin) there, if DVI
-    const char **gsargs = gsargs_ps;
-    const char **arg = gsargs;
-
-    if (no_dvi && is_encapsulated) {
-      gsargs = gsargs_eps;
-      arg = gsargs;
-
-      // find first zero entry and put page size there
-      while (*arg) ++arg;
-      *arg = pagesize;
-
-      // find second zero entry and put resolution there
-      while (*arg) ++arg;
-      *arg = resopt;
-    }
-
-    // find next zero entry and put the filename there
-    QByteArray fname = QFile::encodeName( path );
-    while (*arg)
-      ++arg;
-    if( no_dvi )
-      *arg = fname.data();
+  const QByteArray fname = QFile::encodeName(path);
+
+  // Scale the page to the size of the thumbnail when its size is known,
+  // instead of rendering it at 72 dpi. gs is then left to smooth the
+  // edges, as the image is not scaled down afterwards.
+  QList<QByteArray> pageSize;
+  if (no_dvi && !is_encapsulated && summary.mediaWidth > 0 && summary.mediaHeight > 0) {
+    const int renderWidth = mipmapSize ? qMax(width, mipmapSize) : width;
+    const int renderHeight = mipmapSize ? qMax(height, mipmapSize) : height;
+    const double scale = qMin(double(renderWidth) / summary.mediaWidth,
+                              double(renderHeight) / summary.mediaHeight);
+    const int gswidth = qMax(1, qRound(summary.mediaWidth * scale));
+    const int gsheight = qMax(1, qRound(summary.mediaHeight * scale));
+    gsPageWidth = gswidth;
+    gsPageHeight = gsheight;
+    pageSize << "-r" + QByteArray::number(72 * scale, 'f', 3)
+             << "-g" + QByteArray::number(gswidth) + 'x' + QByteArray::number(gsheight);
+    if (summary.pdf)
+      pageSize << "-dPDFFitPage";
     else
-      *arg = "-";
-
-    // find first zero entry in dvipsargs and put the filename there
-    arg = dvipsargs;
-    while (*arg)
-      ++arg;
-    *arg = fname.data();
-
-    if( !no_dvi ){
-      pipe(dvipipe);
-      pid_t pid_two = fork();
-      if( pid_two == 0 ){
-	// Child process (2), reopen stdout on the pipe "dvipipe" and exec dvips
-
-	close(input[0]);
-	close(input[1]);
-	close(output[0]);
-	close(output[1]);
-	close(dvipipe[0]);
-
-	dup2( dvipipe[1], STDOUT_FILENO);
-
-	execvp(dvipsargs[0], const_cast<char *const *>(dvipsargs));
-	_exit(1);
-      }
-      else if(pid_two != -1){
-	close(input[1]);
-	close(output[0]);
-	close(dvipipe[1]);
-
-	dup2( dvipipe[0], STDIN_FILENO);
-	dup2( output[1], STDOUT_FILENO);
+      pageSize << "-dFIXEDMEDIA" << "-dPSFitPage";
+    pageSize << "-dTextAlphaBits=4" << "-dGraphicsAlphaBits=4";
+  }
 
-	execvp(gsargs[0], const_cast<char *const *>(gsargs));
-	_exit(1);
-      }
-      else{
-	// fork() (2) failed, close these
-	close(dvipipe[0]);
-	close(dvipipe[1]);
-      }
+  // Other pages than the first can only be picked out of PostScript
+  // by its DSC comments
+  const bool postScript = no_dvi && !summary.pdf && !is_encapsulated;
+  QList<GSProcess::Range> ranges;
+  if (postScript && (sliceDocuments || page > 0))
+    ranges = pageRanges(summary);
+  if (postScript && page > 0 && ranges.isEmpty())
+    return KIO::ThumbnailResult::fail();
 
-    }
-    else if( no_dvi ){
-      // Reopen stdin/stdout on the pipes and exec gs
-      close(input[1]);
-      close(output[0]);
+  // On network file systems, gs is first given only the first page
+  // section of linearized PDF files, read in one go instead of in the
+  // many seeks of the PDF interpreter
+  std::unique_ptr<PDFPrefix> prefix;
+  if (summary.pdf && page == 0 && PDFPrefix::isWanted(path)) {
+    TraceSpan span("gs", "pdf-prefix");
+    prefix = std::make_unique<PDFPrefix>(path, summary.mediaWidth, summary.mediaHeight);
+    if (!prefix->isValid())
+      prefix.reset();
+  }
 
-      dup2(input[0], STDIN_FILENO);
-      dup2(output[1], STDOUT_FILENO);
+  GSLimits runLimits = limits;
+  if (summary.pdf)
+    runLimits.timeout = limits.pdfTimeout;
+
+  // Small thumbnails are drawn as drafts, whose blending, interpolation
+  // and font lookups would not show at their size
+  const bool drafting = draft.appliesTo(mipmapSize ? qMax(width, mipmapSize) : width,
+                                        mipmapSize ? qMax(height, mipmapSize) : height);
+  if (drafting && draft.maxBitmap > 0)
+    runLimits.maxBitmap = limits.maxBitmap > 0 ? qMin(limits.maxBitmap, draft.maxBitmap) : draft.maxBitmap;
+
+  // Large pages are rendered in bands on the cores other jobs leave
+  // idle. Every job holds one core of the budget while gs runs.
+  QList<QByteArray> options;
+  if (drafting)
+    options << GSDraftProfile::arguments();
+  const RenderThreads renderThreads(threading.cores(), threading.wantedFor(gsPageWidth, gsPageHeight), threading.shared);
+  if (renderThreads.count() > 1) {
+    qint64 bandedBitmap = 0;
+    options << GSThreading::arguments(renderThreads.count(), gsPageWidth, gsPageHeight, &bandedBitmap);
+    runLimits.maxBitmap = runLimits.maxBitmap > 0 ? qMin(runLimits.maxBitmap, bandedBitmap) : bandedBitmap;
+  }
 
-      execvp(gsargs[0], const_cast<char *const *>(gsargs));
-      _exit(1);
+  GSProcess gs;
+  gs.setLimits(runLimits);
+  gs.setOptions(options);
+  if (summary.pdf) {
+    // Straight to the PDF interpreter, which needs no prolog
+    if (prefix) {
+      gs.setDocument(prefix->fd());
+      gs.setArguments(gsArgumentsPDF("/dev/fd/3", page, pageSize));
+    } else {
+      gs.setArguments(gsArgumentsPDF(fname, page, pageSize));
     }
+  } else if (!no_dvi) {
+    gs.setArguments(gsArgumentsPS("-"));
+    gs.setDviArguments(dvipsArguments(fname, page));
+  } else if (is_encapsulated) {
+    gs.setArguments(gsArgumentsEPS(fname, pagesize, resopt));
+    gs.setInput(QByteArray(epsprolog) + translation);
+  } else if (!ranges.isEmpty()) {
+    // Our prolog, then the document up to the end of its first page
+    gs.setArguments(gsArgumentsPS("-", pageSize));
+    gs.setInput(psprolog);
+    gs.setInputRanges(fname, ranges);
+  } else {
+    gs.setArguments(gsArgumentsPS(fname, pageSize));
+    gs.setInput(psprolog);
   }
-  else if (pid != -1) {
-    // Parent process, write first-page-only-hack (the hack is not
-    // used if DVI) and read the png output
-    close(input[0]);
-    close(output[1]);
-    const char *prolog;
-    if (is_encapsulated)
-      prolog = epsprolog;
-    else
-      prolog = psprolog;
-    int count = write(input[1], prolog, strlen(prolog));
-    if (is_encapsulated)
-      write(input[1], translation, strlen(translation));
-
-    close(input[1]);
-    if (count == static_cast<int>(strlen(prolog))) {
-      int offset = 0;
-	while (!ok) {
-	  fd_set fds;
-	  FD_ZERO(&fds);
-	  FD_SET(output[0], &fds);
-	  struct timeval tv;
-	  tv.tv_sec = 20;
-	  tv.tv_usec = 0;
-
-	  got_sig_term = false;
-	  if (select(output[0] + 1, &fds, nullptr, nullptr, &tv) <= 0) {
-            if ( ( errno == EINTR || errno == EAGAIN ) && !got_sig_term ) continue;
-	    break; // error, timeout or master wants us to quit (SIGTERM)
-          }
-	  if (FD_ISSET(output[0], &fds)) {
-	    count = read(output[0], data.data() + offset, 1024);
-	    if (count == -1)
-	      break;
-	    else
-	      if (count) // prepare for next block
-		{
-		  offset += count;
-		  data.resize(offset + 1024);
-		}
-	      else // got all data
-		{
-		  data.resize(offset);
-		  ok = true;
-		}
-	  }
-	}
-    }
-    if (!ok) // error or timeout, gs probably didn't exit yet
-    {
-      kill(pid, SIGTERM);
-    }
 
-    int status = 0;
-    int ret;
-    do {
-      ret = waitpid(pid, &status, 0);
-    } while (ret == -1 && errno == EINTR);
-    if (ret != pid || (status != 0  && status != 256) )
-      ok = false;
+  {
+    QMutexLocker locker(&lock);
+    job->process = &gs;
+    if (job->cancelled)
+      gs.cancel();
   }
-  else {
-    // fork() (1) failed, close these
-    close(input[0]);
-    close(input[1]);
-    close(output[1]);
+  // As before, a non-zero exit status does not stop us from trying to
+  // read whatever gs produced.
+  const QByteArray pngHeader = "\x89\x50\x4E\x47\x0D\x0A\x1A\x0A";
+  QByteArray data;
+  gs.run(&data);
+  if (prefix && !data.contains(pngHeader)) {
+    // The prefix was not enough after all. The same process, so that
+    // a cancellation meanwhile still counts.
+    data.clear();
+    gs.setDocument(-1);
+    gs.setArguments(gsArgumentsPDF(fname, page, pageSize));
+    gs.run(&data);
+  }
+  {
+    QMutexLocker locker(&lock);
+    job->process = nullptr;
   }
-  close(output[0]);
 
+  TraceSpan decodeSpan("gs", "png-decode");
+  decodeSpan.addBytes(data.size());
   QImage img;
   bool loaded = img.loadFromData( data );
 
   if (!loaded) {
     // Sometimes gs spits some warning messages before the actual image
     // try to skip them
-    const QByteArray pngHeader = "\x89\x50\x4E\x47\x0D\x0A\x1A\x0A";
     const int pngMarkerIndex = data.indexOf(pngHeader);
     if (pngMarkerIndex > 0) {
       data = data.mid(pngMarkerIndex);
@@ -457,33 +671,168 @@ KIO::ThumbnailResult GSCreator::create(const KIO::ThumbnailRequest &request)
     }
   }
 
-  if ( got_sig_term &&
-	oldhandler != SIG_ERR &&
-	oldhandler != SIG_DFL &&
-	oldhandler != SIG_IGN ) {
-	  oldhandler( SIGTERM ); // propagate the signal. Other things might rely on it
+  decodeSpan.end();
+
+  // Only what gs did with the document is held against it, not a
+  // cancellation, a missing gs or a shortage of descriptors
+  const GSProcess::Status status = gs.status();
+  const bool ran = status == GSProcess::Succeeded || status == GSProcess::Failed
+    || status == GSProcess::TimedOut || status == GSProcess::Crashed;
+  if (haveKey && limits.retryAfter > 0 && ran) {
+    DSCIndex::Failure outcome;
+    if (status == GSProcess::TimedOut)
+      outcome.kind = DSCIndex::Failure::Timeout;
+    else if (status == GSProcess::Crashed)
+      outcome.kind = DSCIndex::Failure::Crash;
+    else if (!loaded)
+      outcome.kind = DSCIndex::Failure::BadOutput;
+    if (outcome.kind != DSCIndex::Failure::None) {
+      outcome.count = failed ? failure.count + 1 : 1;
+      outcome.time = QDateTime::currentSecsSinceEpoch();
+      outcome.version = rendererVersion;
+      dscIndex.insertFailure(key, outcome);
+    } else if (failed) {
+      dscIndex.insertFailure(key, outcome);
+    }
+  }
+
+  if (loaded && mipmapSize && page == 0) {
+    const QList<QImage> chain = Mipmaps::build(img, qMax(mipmapSize, Mipmaps::bucketFor(qMax(width, height))));
+    QMutexLocker locker(&lock);
+    if (haveKey) {
+      qint64 cost = 0;
+      for (const QImage &level : chain)
+        cost += level.sizeInBytes();
+      mipmapCache.insert(key, new QList<QImage>(chain), cost / 1024);
+    }
+    return withPageCount(KIO::ThumbnailResult::pass(Mipmaps::pick(chain, request.targetSize())), pageCount);
   }
-  if ( oldhandler != SIG_ERR ) signal( SIGTERM, oldhandler );
 
   if (loaded) {
-    return KIO::ThumbnailResult::pass(img);
+    return withPageCount(KIO::ThumbnailResult::pass(img), pageCount);
   }
 
   return KIO::ThumbnailResult::fail();
 }
 
-void GSCreator::comment(Name name)
+// Find out what kind of document this is and what its DSC comments
+// say, up to where @p page, counted from 0, ends if that is wanted.
+// Returns false if the file cannot be read.
+bool GSCreator::scanDocument(const QString &path, unsigned int page, DSCSummary *summary)
 {
-    switch (name) {
-    case EndPreview:
-    case BeginProlog:
-    case Page:
-      endComments = true;
-      break;
+  FILE* fp = fopen(QFile::encodeName(path), "r");
+  if (fp == nullptr) return false;
+
+  // PDF, the most common by far, is told by its first bytes. It has no
+  // DSC comments and gs finds its pages by itself.
+  QByteArray head(5, '\0');
+  if (fread(head.data(), sizeof(char), head.size(), fp) == size_t(head.size())
+      && head == "%PDF-") {
+    summary->pdf = true;
+    scanPDF(fp, head, summary);
+    fclose(fp);
+    return true;
+  }
+  rewind(fp);
 
-    default:
-      break;
+  // Test if file is DVI
+  if (correctDVI(path)) {
+    fclose(fp);
+    summary->dvi = true;
+    summary->pageCount = dviPageCount(path);
+    return true;
+  }
+
+  KDSC dsc;
+  HeaderEndHandler header;
+  header.wantedPage = page + 1;
+  dsc.setCommentHandler(&header);
+
+  char buf[4096];
+  int count;
+  unsigned long scanned = 0;
+  while (!header.endComments
+         && (count = fread(buf, sizeof(char), 4096, fp)) != 0) {
+    dsc.scanData(buf, count);
+    scanned += count;
+  }
+
+  // Photoshop writes the image resources holding its thumbnail after
+  // the setup, ahead of the raster
+  if (header.endComments && dsc.dsc_creator().contains(QLatin1String("Photoshop"))) {
+    const unsigned long end = scanned + photoshopReadLength;
+    while (!header.endPhotoshop && header.pages == 0 && scanned < end
+           && (count = fread(buf, sizeof(char), 4096, fp)) != 0) {
+      dsc.scanData(buf, count);
+      scanned += count;
+    }
+  }
+
+  // To slice the document, go on to where the page ends. The last one
+  // ends with the file, if there is no trailer.
+  if ((sliceDocuments || page > 0) && !dsc.cdsc()->doseps) {
+    while (!header.pageEnd
+           && (count = fread(buf, sizeof(char), 4096, fp)) != 0) {
+      dsc.scanData(buf, count);
+      scanned += count;
+    }
+    if (header.pageBegin) {
+      summary->beginProlog = dsc.beginprolog();
+      summary->endProlog = dsc.endprolog();
+      summary->beginSetup = dsc.beginsetup();
+      summary->endSetup = dsc.endsetup();
+      summary->beginPage = header.pageBegin;
+      summary->endPage = header.pageEnd ? header.pageEnd : scanned;
+    }
+  }
+
+  // We stopped after the header, so values deferred with (atend)
+  // are still unknown. Read them from the trailer at the end of the
+  // file instead of scanning the whole document.
+  if (header.endComments && dsc.atend()) {
+    long end = -1;
+    if (const CDSCDOSEPS *doseps = dsc.cdsc()->doseps)
+      end = static_cast<long>(doseps->ps_begin + doseps->ps_length);
+    else if (fseek(fp, 0, SEEK_END) == 0)
+      end = ftell(fp);
+    const long start = qMax(0L, end - trailerReadLength);
+    if (end > start && fseek(fp, start, SEEK_SET) == 0) {
+      QByteArray trailer(end - start, '\0');
+      count = fread(trailer.data(), sizeof(char), trailer.size(), fp);
+      dsc.scanTrailer(trailer.data(), count, start);
     }
+  }
+  fclose(fp);
+
+  summary->pjl = dsc.pjl();
+  summary->ctrld = dsc.ctrld();
+  if (std::unique_ptr<KDSCBBOX> bbox = dsc.bbox()) {
+    summary->hasBBox = true;
+    summary->llx = bbox->llx();
+    summary->lly = bbox->lly();
+    summary->urx = bbox->urx();
+    summary->ury = bbox->ury();
+  }
+  summary->pageCount = qMax(dsc.page_count(), dsc.page_pages());
+  summary->preview = dsc.preview();
+  summary->beginPreview = dsc.beginpreview();
+  summary->endPreview = dsc.endpreview();
+  summary->beginPhotoshop = dsc.beginphotoshop();
+  summary->endPhotoshop = dsc.endphotoshop();
+
+  // The page size, from the media of the document or else its
+  // bounding box
+  const CDSCMEDIA *media = dsc.page_media();
+  if (!media && dsc.media_count() > 0)
+    media = dsc.media()[0];
+  if (media && media->width >= 1 && media->height >= 1) {
+    summary->mediaWidth = qRound(media->width);
+    summary->mediaHeight = qRound(media->height);
+  } else if (summary->hasBBox && summary->urx > 0 && summary->ury > 0) {
+    summary->mediaWidth = summary->urx;
+    summary->mediaHeight = summary->ury;
+  }
+  return true;
 }
 
 // Quick function to check if the filename corresponds to a valid DVI
@@ -512,6 +861,101 @@ static bool correctDVI(const QString& filename)
   return true;
 }
 
+// The total page count of a DVI file, from its postamble, or 0.
+static unsigned int dviPageCount(const QString& filename)
+{
+  QFile f(filename);
+  if (!f.open(QIODevice::ReadOnly))
+    return 0;
+
+  // post_post, the address of post, the DVI id and at least four 223s
+  if (!f.seek(qMax<qint64>(0, f.size() - 64)))
+    return 0;
+  const QByteArray tail = f.read(64);
+  qsizetype i = tail.size() - 1;
+  while (i >= 0 && static_cast<unsigned char>(tail[i]) == 223)
+    i--;
+  if (i < 5 || static_cast<unsigned char>(tail[i - 5]) != 249)
+    return 0;
+  const uchar *q = reinterpret_cast<const uchar *>(tail.constData()) + i - 4;
+  const qint64 post = (qint64(q[0]) << 24) | (q[1] << 16) | (q[2] << 8) | q[3];
+
+  // post p[4] num[4] den[4] mag[4] l[4] u[4] s[2] t[2]
+  unsigned char postamble[29];
+  if (!f.seek(post) || f.read((char *)postamble, sizeof(postamble)) != sizeof(postamble)
+      || postamble[0] != 248)
+    return 0;
+  return (postamble[27] << 8) | postamble[28];
+}
+
+// The page count and size of a PDF file, where they are found.
+// Linearized files give the count in their first bytes. Otherwise it
+// is the count of the root of the page tree. It and the page boxes are
+// looked for near the start and the end of the file, they are not
+// found in compressed object streams.
+static void scanPDF(FILE *fp, const QByteArray &head, DSCSummary *summary)
+{
+  QByteArray data = head;
+  data.resize(pdfCountReadLength);
+  data.resize(head.size() + fread(data.data() + head.size(), sizeof(char), data.size() - head.size(), fp));
+
+  static const QRegularExpression linearized(QStringLiteral("/Linearized\\s[^>]*?/N\\s+(\\d+)"));
+  const QRegularExpressionMatch match = linearized.match(QString::fromLatin1(data.left(1024)));
+  if (match.hasMatch()) {
+    summary->pageCount = match.captured(1).toUInt();
+  } else if (fseek(fp, 0, SEEK_END) == 0) {
+    const long end = ftell(fp);
+    const long tailStart = qMax(long(data.size()), end - long(pdfCountReadLength));
+    if (end > tailStart && fseek(fp, tailStart, SEEK_SET) == 0) {
+      QByteArray tail(end - tailStart, '\0');
+      tail.resize(fread(tail.data(), sizeof(char), tail.size(), fp));
+      data += tail;
+    }
+  }
+  const QString text = QString::fromLatin1(data);
+
+  if (!summary->pageCount) {
+    static const QRegularExpression pages(QStringLiteral(
+      "/Type\\s*/Pages(?![A-Za-z])[^>]*?/Count\\s+(\\d+)"
+      "|/Count\\s+(\\d+)[^>]*?/Type\\s*/Pages(?![A-Za-z])"));
+    QRegularExpressionMatchIterator it = pages.globalMatch(text);
+    while (it.hasNext()) {
+      const QRegularExpressionMatch match = it.next();
+      const QString number = match.captured(1).isEmpty() ? match.captured(2) : match.captured(1);
+      summary->pageCount = qMax(summary->pageCount, number.toUInt());
+    }
+  }
+
+  // The first page box found. What is shown of a page is its crop box,
+  // which defaults to its media box, so a crop box only takes over from
+  // the media box of its own object. Boxes further on are of other
+  // pages, or of forms.
+  static const QRegularExpression box(QStringLiteral(
+    "/(CropBox|MediaBox)\\s*\\[\\s*([-+.\\d]+)\\s+([-+.\\d]+)\\s+([-+.\\d]+)\\s+([-+.\\d]+)\\s*\\]"));
+  bool found = false;
+  qsizetype boxObject = -1;
+  QRegularExpressionMatchIterator it = box.globalMatch(text);
+  while (it.hasNext()) {
+    const QRegularExpressionMatch match = it.next();
+    const int boxWidth = qRound(qAbs(match.captured(4).toDouble() - match.captured(2).toDouble()));
+    const int boxHeight = qRound(qAbs(match.captured(5).toDouble() - match.captured(3).toDouble()));
+    if (boxWidth <= 0 || boxHeight <= 0)
+      continue;
+    const qsizetype object = text.lastIndexOf(QLatin1String("obj"), match.capturedStart());
+    if (found && object != boxObject)
+      break;
+    const bool crop = match.captured(1) == QLatin1String("CropBox");
+    if (!found || crop) {
+      summary->mediaWidth = boxWidth;
+      summary->mediaHeight = boxHeight;
+    }
+    found = true;
+    boxObject = object;
+    if (crop)
+      break;
+  }
+}
+
 KIO::ThumbnailResult GSCreator::getEPSIPreview(const QString &path, long start, long
 			       end, int imgwidth, int imgheight)
 {
@@ -8,20 +8,78 @@
 #define _GSCREATOR_H_
 
 #include <KIO/ThumbnailCreator>
+#include <KPluginMetaData>
+#include <QCache>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include "dscindex.h"
 #include "dscparse_adapter.h"
+#include "gsprocess.h"
+#include "thumbnaildedup.h"
 
-class GSCreator : public KIO::ThumbnailCreator, public KDSCCommentHandler
+/**
+ * Thumbnails for PostScript and DVI files, rendered by Ghostscript.
+ *
+ * create() may be called from several threads at the same time.
+ */
+class GSCreator : public KIO::ThumbnailCreator
 {
 public:
     GSCreator(QObject *parent, const QVariantList &args);
+    GSCreator(QObject *parent, const KPluginMetaData &metaData, const QVariantList &args);
     KIO::ThumbnailResult create(const KIO::ThumbnailRequest &request) override;
-    void comment(Name name) override;
+
+    /**
+     * Stop the rendering of @p request, or of an equal request: for the
+     * same file, size, pixel ratio and page. Its create() call returns
+     * a failure, also when it has not started gs yet, and those of
+     * other requests go on. Safe to call from any thread.
+     */
+    void cancel(const KIO::ThumbnailRequest &request);
+
+    /**
+     * With mipmaps enabled, the thumbnails of every bucket of the first
+     * page of the file of @p request, largest first, as rendered by a
+     * create() call for that file, so that the caller can store all of
+     * them. Empty if there are none, e.g. as the file changed since.
+     * Safe to call from any thread.
+     */
+    QList<QImage> mipmaps(const KIO::ThumbnailRequest &request);
 
 private:
+    // A create() call in progress
+    struct Job {
+        const KIO::ThumbnailRequest &request;
+        // While gs runs
+        GSProcess *process = nullptr;
+        bool cancelled = false;
+    };
+
+    KIO::ThumbnailResult render(const KIO::ThumbnailRequest &request, Job *job);
+    bool scanDocument(const QString &path, unsigned int page, DSCSummary *summary);
     static KIO::ThumbnailResult getEPSIPreview(const QString &path,
                                long start, long end,
                                int imgwidth, int imgheight);
-    bool endComments;
+    DSCIndex dscIndex;
+    const GSLimits limits;
+    const GSDraftProfile draft;
+    const GSThreading threading;
+    ThumbnailDedup dedup;
+
+    // With GSTHUMBNAIL_SLICE=1, gs is only fed the prolog, setup and
+    // first page of PostScript documents whose DSC comments tell where
+    // they are, and never sees the other pages, even when the document
+    // defeats our redefinition of showpage.
+    const bool sliceDocuments;
+
+    // Guards the members below
+    mutable QMutex lock;
+    QList<Job *> jobs;
+
+    // Largest mipmap size, or 0 when mipmaps are disabled
+    int mipmapSize;
+    QCache<DSCIndex::Key, QList<QImage>> mipmapCache;
 };
 
 #endif
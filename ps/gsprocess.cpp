@@ -0,0 +1,772 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "gsprocess.h"
+#include "trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <QAtomicInteger>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QFile>
+#include <QJsonObject>
+#include <QScopeGuard>
+#include <QThread>
+
+#if defined(Q_OS_LINUX)
+#include <sys/sendfile.h>
+#endif
+
+#include <vector>
+
+extern char **environ;
+
+namespace
+{
+// Where gs finds the document given with setDocument()
+const int documentFd = 3;
+
+std::vector<char *> argumentVector(const QList<QByteArray> &arguments)
+{
+    std::vector<char *> argv;
+    argv.reserve(arguments.size() + 1);
+    for (const QByteArray &argument : arguments) {
+        argv.push_back(const_cast<char *>(argument.constData()));
+    }
+    argv.push_back(nullptr);
+    return argv;
+}
+
+// Start @p argv with its standard input and output connected to @p in
+// and @p out, and @p document, if any, as its descriptor 3. posix_spawn() lets the C library use vfork() or
+// clone(CLONE_VM), so the cost of starting gs does not grow with the
+// size of the thumbnailer, whose page tables fork() would have to copy.
+pid_t spawn(int in, int out, int document, char *const *argv)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attributes;
+    if (posix_spawn_file_actions_init(&actions) != 0) {
+        return -1;
+    }
+    if (posix_spawnattr_init(&attributes) != 0) {
+        posix_spawn_file_actions_destroy(&actions);
+        return -1;
+    }
+
+    // All our pipes are close-on-exec, dup2() clears the flag on the copy
+    if (in != -1) {
+        posix_spawn_file_actions_adddup2(&actions, in, STDIN_FILENO);
+    }
+    posix_spawn_file_actions_adddup2(&actions, out, STDOUT_FILENO);
+    if (document != -1) {
+        posix_spawn_file_actions_adddup2(&actions, document, documentFd);
+    }
+
+    // The thumbnailer may ignore SIGPIPE, the children must not: when
+    // we go away, their output pipe breaks and that is what stops them.
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    sigset_t mask;
+    sigemptyset(&mask);
+    posix_spawnattr_setsigdefault(&attributes, &defaults);
+    posix_spawnattr_setsigmask(&attributes, &mask);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+
+    pid_t pid;
+    if (posix_spawnp(&pid, argv[0], &actions, &attributes, argv, environ) != 0) {
+        pid = -1;
+    }
+
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+    return pid;
+}
+
+// Exit status of the shell below when a limit cannot be set. 126 and
+// 127 are its own for a command that cannot be run.
+const int limitFailure = 125;
+
+// A word of a shell command for @p text, whatever it holds
+QByteArray shellQuoted(const QByteArray &text)
+{
+    QByteArray quoted = text;
+    quoted.replace('\'', "'\\''");
+    return '\'' + quoted + '\'';
+}
+
+// posix_spawn() has no way to set resource limits on the child, nor to
+// move it into a cgroup, and setting limits here would apply to the
+// other threads of the thumbnailer too. A shell sets them between fork
+// and exec instead, and joins the cgroup leaf @p cgroup unless it is
+// empty, so that they are in place before gs allocates anything or
+// reads a byte of the document, and gives up if one cannot be set.
+QList<QByteArray> limited(const QList<QByteArray> &arguments, const GSLimits &limits, const QString &cgroup)
+{
+#if defined(Q_OS_LINUX)
+    QByteArray script;
+    if (!cgroup.isEmpty()) {
+        script += "echo $$ > " + shellQuoted(QFile::encodeName(cgroup + QLatin1String("/cgroup.procs"))) + " && ";
+    }
+    if (limits.cpu > 0) {
+        // SIGXCPU at the soft limit, SIGKILL a second later
+        script += "ulimit -S -t " + QByteArray::number(limits.cpu) + " && ulimit -H -t " + QByteArray::number(limits.cpu + 1) + " && ";
+    }
+    if (limits.memory > 0) {
+        script += "ulimit -v " + QByteArray::number(limits.memory / 1024) + " && ";
+    }
+    if (limits.fileSize > 0) {
+        // In blocks of 512 bytes
+        script += "ulimit -f " + QByteArray::number((limits.fileSize + 511) / 512) + " && ";
+    }
+    if (limits.openFiles > 0) {
+        script += "ulimit -n " + QByteArray::number(limits.openFiles) + " && ";
+    }
+    if (script.isEmpty() || arguments.isEmpty()) {
+        return arguments;
+    }
+    script += "exec \"$@\"; exit " + QByteArray::number(limitFailure);
+    return QList<QByteArray>{"/bin/sh", "-c", script, arguments.first()} + arguments;
+#else
+    Q_UNUSED(limits);
+    Q_UNUSED(cgroup);
+    return arguments;
+#endif
+}
+
+bool writeFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+// The environment wins over the plugin metadata
+void configure(qint64 *value, const QJsonObject &config, const char *key, const char *variable)
+{
+    const QJsonValue json = config.value(QLatin1String(key));
+    if (json.isDouble()) {
+        *value = json.toInteger();
+    }
+    bool ok = false;
+    const qint64 env = qEnvironmentVariable(variable).toLongLong(&ok);
+    if (ok) {
+        *value = env;
+    }
+}
+
+void configure(int *value, const QJsonObject &config, const char *key, const char *variable)
+{
+    qint64 wide = *value;
+    configure(&wide, config, key, variable);
+    *value = int(qBound<qint64>(-1, wide, INT_MAX));
+}
+
+// Copy up to @p count bytes of @p in from @p offset to @p out, which
+// may be a non-blocking pipe, and advance @p offset by what was copied.
+ssize_t copyRange(int out, int in, off_t *offset, qint64 count)
+{
+    const size_t chunk = size_t(qMin<qint64>(count, 1 << 20));
+#if defined(Q_OS_LINUX)
+    // Straight from the page cache into the pipe
+    const ssize_t sent = sendfile(out, in, offset, chunk);
+    if (sent != -1 || (errno != EINVAL && errno != ENOSYS)) {
+        return sent;
+    }
+#endif
+    char buffer[16384];
+    const ssize_t length = pread(in, buffer, qMin(chunk, sizeof(buffer)), *offset);
+    if (length <= 0) {
+        return length;
+    }
+    const ssize_t written = write(out, buffer, length);
+    if (written > 0) {
+        *offset += written;
+    }
+    return written;
+}
+
+// What is left to write to the standard input of gs: the input data,
+// then the ranges of the source file.
+class Feeder
+{
+public:
+    Feeder(const QByteArray &data, int source, const QList<GSProcess::Range> &ranges)
+        : m_data(data)
+        , m_source(source)
+        , m_ranges(ranges)
+    {
+        next();
+    }
+
+    bool atEnd() const
+    {
+        return m_written == m_data.size() && m_range == m_ranges.size();
+    }
+
+    // Write as much as @p fd takes without blocking. Returns false on
+    // errors; gs having quit, which breaks the pipe, is not one.
+    bool feed(int fd)
+    {
+        while (!atEnd()) {
+            ssize_t count;
+            if (m_written < m_data.size()) {
+                count = write(fd, m_data.constData() + m_written, m_data.size() - m_written);
+                if (count > 0) {
+                    m_written += count;
+                }
+            } else {
+                count = copyRange(fd, m_source, &m_offset, m_ranges.at(m_range).end - m_offset);
+                if (count == 0) {
+                    return false; // the file got shorter
+                }
+                if (count > 0 && m_offset >= m_ranges.at(m_range).end) {
+                    ++m_range;
+                    next();
+                }
+            }
+
+            if (count == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN) {
+                    return true;
+                }
+                if (errno == EPIPE) {
+                    finish();
+                    return true;
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void finish()
+    {
+        m_written = m_data.size();
+        m_range = m_ranges.size();
+    }
+
+private:
+    // Skip empty ranges
+    void next()
+    {
+        while (m_range < m_ranges.size() && m_ranges.at(m_range).end <= m_ranges.at(m_range).begin) {
+            ++m_range;
+        }
+        if (m_range < m_ranges.size()) {
+            m_offset = m_ranges.at(m_range).begin;
+        }
+    }
+
+    const QByteArray m_data;
+    const int m_source;
+    const QList<GSProcess::Range> m_ranges;
+    qsizetype m_written = 0;
+    qsizetype m_range = 0;
+    off_t m_offset = 0;
+};
+
+// Writing to a pipe that gs closed raises SIGPIPE, which would kill
+// us unless the application ignores it. Block it for this thread only
+// while feeding gs, and discard one raised meanwhile before unblocking.
+class PipeSignalBlocker
+{
+public:
+    PipeSignalBlocker()
+    {
+        sigemptyset(&m_pipe);
+        sigaddset(&m_pipe, SIGPIPE);
+        sigset_t pending;
+        sigpending(&pending);
+        m_wasPending = sigismember(&pending, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &m_pipe, &m_old);
+    }
+
+    ~PipeSignalBlocker()
+    {
+        sigset_t pending;
+        sigpending(&pending);
+        if (!m_wasPending && sigismember(&pending, SIGPIPE)) {
+            const timespec zero = {0, 0};
+            while (sigtimedwait(&m_pipe, nullptr, &zero) == -1 && errno == EINTR) { }
+        }
+        pthread_sigmask(SIG_SETMASK, &m_old, nullptr);
+    }
+
+private:
+    sigset_t m_pipe;
+    sigset_t m_old;
+    bool m_wasPending;
+};
+
+// How long a child sent SIGTERM has to exit before it is sent SIGKILL,
+// in milliseconds. gs busy in a loop of its own, or a child stopped by a
+// debugger, would not.
+const int terminateGrace = 2000;
+
+// gs may exit with 1 after rendering the page, e.g. because of the
+// showpage hack in the prolog.
+// Whether the child exited with 0 or 1. @p signaled tells whether it
+// was killed by a signal instead, @p started whether it got past the
+// shell setting its limits. With @p terminated, the child was sent
+// SIGTERM, and it is killed if it is still running after the grace
+// period.
+bool waitFor(pid_t pid, bool *signaled = nullptr, bool *started = nullptr, bool terminated = false)
+{
+    int status = 0;
+    pid_t ret = 0;
+    if (terminated) {
+        const QDeadlineTimer grace(terminateGrace);
+        int pause = 1;
+        while ((ret = waitpid(pid, &status, WNOHANG)) == 0 || (ret == -1 && errno == EINTR)) {
+            if (grace.hasExpired()) {
+                kill(pid, SIGKILL);
+                ret = 0;
+                break;
+            }
+            QThread::msleep(qMin<qint64>(pause, grace.remainingTime()));
+            pause = qMin(pause * 2, 50);
+        }
+    }
+    while (ret == 0 || (ret == -1 && errno == EINTR)) {
+        ret = waitpid(pid, &status, 0);
+    }
+    if (signaled) {
+        *signaled = ret == pid && WIFSIGNALED(status);
+    }
+    if (started) {
+        *started = ret == pid && !(WIFEXITED(status) && WEXITSTATUS(status) >= limitFailure && WEXITSTATUS(status) <= 127);
+    }
+    return ret == pid && (status == 0 || status == 256);
+}
+}
+
+GSLimits GSLimits::fromConfig(const QJsonObject &config)
+{
+    GSLimits limits;
+    configure(&limits.timeout, config, "Timeout", "GSTHUMBNAIL_TIMEOUT");
+    configure(&limits.pdfTimeout, config, "PdfTimeout", "GSTHUMBNAIL_PDF_TIMEOUT");
+    configure(&limits.cpu, config, "Cpu", "GSTHUMBNAIL_CPU");
+    configure(&limits.memory, config, "Memory", "GSTHUMBNAIL_MEMORY");
+    configure(&limits.fileSize, config, "FileSize", "GSTHUMBNAIL_FILE_SIZE");
+    configure(&limits.openFiles, config, "OpenFiles", "GSTHUMBNAIL_OPEN_FILES");
+    configure(&limits.maxBitmap, config, "MaxBitmap", "GSTHUMBNAIL_MAX_BITMAP");
+    configure(&limits.bufferSpace, config, "BufferSpace", "GSTHUMBNAIL_BUFFER_SPACE");
+    configure(&limits.retryAfter, config, "RetryAfter", "GSTHUMBNAIL_RETRY_AFTER");
+
+    limits.cgroup = config.value(QLatin1String("Cgroup")).toString();
+    if (qEnvironmentVariableIsSet("GSTHUMBNAIL_CGROUP")) {
+        limits.cgroup = qEnvironmentVariable("GSTHUMBNAIL_CGROUP");
+    }
+    return limits;
+}
+
+bool GSDraftProfile::appliesTo(int width, int height) const
+{
+    return maxSize > 0 && width <= maxSize && height <= maxSize;
+}
+
+QList<QByteArray> GSDraftProfile::arguments()
+{
+    return {
+        // Images end up smaller than they are anyway
+        "-dNOINTERPOLATE",
+        // Transparent objects are painted opaque instead of blended
+        "-dNOTRANSPARENCY",
+        "-dOverprint=/disable",
+        // A missing font is substituted instead of looked for
+        "-dNOPLATFONTS",
+    };
+}
+
+GSDraftProfile GSDraftProfile::fromConfig(const QJsonObject &config)
+{
+    GSDraftProfile draft;
+    configure(&draft.maxSize, config, "MaxSize", "GSTHUMBNAIL_DRAFT_SIZE");
+    configure(&draft.maxBitmap, config, "MaxBitmap", "GSTHUMBNAIL_DRAFT_MAX_BITMAP");
+    return draft;
+}
+
+int GSThreading::cores() const
+{
+    return budget > 0 ? budget : QThread::idealThreadCount();
+}
+
+int GSThreading::wantedFor(int width, int height) const
+{
+    if (minPixels <= 0 || qint64(width) * height < minPixels) {
+        return 1;
+    }
+    return qBound(1, perJob, cores());
+}
+
+QList<QByteArray> GSThreading::arguments(int threads, int width, int height, qint64 *maxBitmap)
+{
+    // A few bands per thread, so that one slow band does not leave the
+    // others idle, of 24 bit pixels
+    const int bandHeight = qMax(16, (height + 4 * threads - 1) / (4 * threads));
+    const qint64 bandBytes = qint64(width) * 3 * bandHeight;
+    const qint64 bandBufferSpace = qMax(bandBytes * 2, qint64(1) << 20);
+
+    // Only pages larger than the bitmap are banded
+    *maxBitmap = qMin(bandBufferSpace, qint64(width) * 3 * height / 2);
+
+    return {
+        "-dNumRenderingThreads=" + QByteArray::number(threads),
+        "-dBandHeight=" + QByteArray::number(bandHeight),
+        "-dBandBufferSpace=" + QByteArray::number(bandBufferSpace),
+    };
+}
+
+GSThreading GSThreading::fromConfig(const QJsonObject &config)
+{
+    GSThreading threading;
+    configure(&threading.budget, config, "Budget", "GSTHUMBNAIL_THREADS");
+    configure(&threading.perJob, config, "PerJob", "GSTHUMBNAIL_THREADS_PER_JOB");
+    configure(&threading.minPixels, config, "MinPixels", "GSTHUMBNAIL_THREADED_PIXELS");
+
+    threading.shared = config.value(QLatin1String("Shared")).toString();
+    if (qEnvironmentVariableIsSet("GSTHUMBNAIL_THREADS_SHARED")) {
+        threading.shared = qEnvironmentVariable("GSTHUMBNAIL_THREADS_SHARED");
+    }
+    return threading;
+}
+
+GSProcess::GSProcess()
+    : m_document(-1)
+    , m_status(NotStarted)
+{
+    if (pipe2(m_cancelPipe, O_CLOEXEC | O_NONBLOCK) == -1) {
+        m_cancelPipe[0] = m_cancelPipe[1] = -1;
+    }
+}
+
+GSProcess::~GSProcess()
+{
+    if (m_cancelPipe[0] != -1) {
+        close(m_cancelPipe[0]);
+        close(m_cancelPipe[1]);
+    }
+}
+
+void GSProcess::setArguments(const QList<QByteArray> &arguments)
+{
+    m_arguments = arguments;
+}
+
+void GSProcess::setOptions(const QList<QByteArray> &options)
+{
+    m_options = options;
+}
+
+void GSProcess::setDviArguments(const QList<QByteArray> &arguments)
+{
+    m_dviArguments = arguments;
+}
+
+void GSProcess::setInput(const QByteArray &input)
+{
+    m_input = input;
+}
+
+void GSProcess::setInputRanges(const QByteArray &fileName, const QList<Range> &ranges)
+{
+    m_rangeFile = fileName;
+    m_ranges = ranges;
+}
+
+void GSProcess::setDocument(int fd)
+{
+    m_document = fd;
+}
+
+void GSProcess::setLimits(const GSLimits &limits)
+{
+    m_limits = limits;
+}
+
+GSProcess::Status GSProcess::status() const
+{
+    return m_status;
+}
+
+void GSProcess::cancel()
+{
+    // Stays readable, so run() also stops if it has not started yet
+    const char byte = 0;
+    if (m_cancelPipe[1] != -1) {
+        (void)write(m_cancelPipe[1], &byte, 1);
+    }
+}
+
+bool GSProcess::run(QByteArray *output)
+{
+    m_status = NotStarted;
+    const bool dvi = !m_dviArguments.isEmpty();
+
+    // Band the page instead of allocating a huge bitmap for it
+    QList<QByteArray> arguments = m_arguments;
+    if (!arguments.isEmpty()) {
+        for (qsizetype i = m_options.size(); i > 0; --i) {
+            arguments.insert(1, m_options.at(i - 1));
+        }
+        if (m_limits.bufferSpace > 0) {
+            arguments.insert(1, "-dBufferSpace=" + QByteArray::number(m_limits.bufferSpace));
+        }
+        if (m_limits.maxBitmap > 0) {
+            arguments.insert(1, "-dMaxBitmap=" + QByteArray::number(m_limits.maxBitmap));
+        }
+    }
+
+    // A run whose cgroup cannot be set up is not started, like one whose
+    // limits cannot be set. The leaf is empty again once the children
+    // have been reaped.
+    const QString cgroup = createCgroup();
+    if (!m_limits.cgroup.isEmpty() && cgroup.isEmpty()) {
+        return false;
+    }
+    const auto removeCgroup = qScopeGuard([&cgroup] {
+        if (!cgroup.isEmpty()) {
+            QDir().rmdir(cgroup);
+        }
+    });
+
+    // Kept alive until the children have been spawned
+    const QList<QByteArray> gsCommand = limited(arguments, m_limits, cgroup);
+    const QList<QByteArray> dvipsCommand = limited(m_dviArguments, m_limits, cgroup);
+    const std::vector<char *> gsArgv = argumentVector(gsCommand);
+    const std::vector<char *> dvipsArgv = argumentVector(dvipsCommand);
+
+    // Parts of the document, streamed to gs after our input
+    int source = -1;
+    if (!dvi && !m_rangeFile.isEmpty()) {
+        source = open(m_rangeFile.constData(), O_RDONLY | O_CLOEXEC);
+        if (source == -1) {
+            return false;
+        }
+    }
+
+    // dup2() onto itself would leave the descriptor close-on-exec
+    int document = m_document;
+    if (document == documentFd) {
+        document = fcntl(document, F_DUPFD_CLOEXEC, documentFd + 1);
+        if (document == -1) {
+            if (source != -1) {
+                close(source);
+            }
+            return false;
+        }
+    }
+    const auto closeDocument = [&document, this]() {
+        if (document != m_document) {
+            close(document);
+        }
+    };
+
+    // gs reads from input, which we or dvips write to
+    int input[2];
+    int out[2];
+    if (pipe2(input, O_CLOEXEC) == -1) {
+        if (source != -1) {
+            close(source);
+        }
+        closeDocument();
+        return false;
+    }
+    if (pipe2(out, O_CLOEXEC) == -1) {
+        close(input[0]);
+        close(input[1]);
+        if (source != -1) {
+            close(source);
+        }
+        closeDocument();
+        return false;
+    }
+
+    // The time limit covers the whole run, from here on
+    const QDeadlineTimer deadline(m_limits.timeout);
+
+    TraceSpan spawnSpan("gs", "spawn");
+    pid_t dvipsPid = -1;
+    if (dvi) {
+        dvipsPid = spawn(-1, input[1], -1, dvipsArgv.data());
+    }
+
+    pid_t gsPid = -1;
+    if (!dvi || dvipsPid != -1) {
+        gsPid = spawn(input[0], out[1], document, gsArgv.data());
+    }
+
+    spawnSpan.end();
+
+    close(input[0]);
+    close(out[1]);
+    closeDocument();
+
+    TraceSpan renderSpan("gs", "render");
+    bool ok = false;
+    if (gsPid != -1) {
+        m_status = Error;
+        if (dvi) {
+            // dvips has its own copy
+            close(input[1]);
+            input[1] = -1;
+        } else {
+            // Only our end, gs keeps blocking reads
+            fcntl(input[1], F_SETFL, fcntl(input[1], F_GETFL) | O_NONBLOCK);
+        }
+        PipeSignalBlocker blocker;
+        ok = communicate(input[1], source, out[0], output, deadline);
+        input[1] = -1;
+    }
+    renderSpan.addBytes(output->size());
+    renderSpan.end();
+    if (input[1] != -1) {
+        close(input[1]);
+    }
+    close(out[0]);
+    if (source != -1) {
+        close(source);
+    }
+
+    const bool terminated = !ok;
+    if (terminated) {
+        // error, timeout or cancelled, the children may still be running
+        if (gsPid != -1) {
+            kill(gsPid, SIGTERM);
+        }
+        if (dvipsPid != -1) {
+            kill(dvipsPid, SIGTERM);
+        }
+    }
+
+    // Only what gs did by itself tells about the document
+    bool signaled = false;
+    bool started = true;
+    const bool exited = gsPid != -1 && waitFor(gsPid, &signaled, &started, terminated);
+    if (ok) {
+        m_status = exited ? Succeeded : signaled ? Crashed : Failed;
+        ok = exited;
+    }
+    bool dvipsStarted = true;
+    if (dvipsPid != -1) {
+        waitFor(dvipsPid, nullptr, &dvipsStarted, terminated);
+    }
+    if (!started || !dvipsStarted) {
+        // Its limits could not be set, or gs or dvips is not installed
+        m_status = NotStarted;
+        ok = false;
+    }
+
+    return ok;
+}
+
+// A leaf of the delegated cgroup for the children of this run, or an
+// empty string if there is none or it cannot be set up.
+QString GSProcess::createCgroup() const
+{
+    if (m_limits.cgroup.isEmpty()) {
+        return QString();
+    }
+
+    static QAtomicInteger<quint32> counter;
+    const QString leaf = m_limits.cgroup + QStringLiteral("/gsthumbnail-%1-%2").arg(getpid()).arg(counter.fetchAndAddRelaxed(1));
+    if (!QDir().mkdir(leaf)) {
+        return QString();
+    }
+    if (m_limits.memory > 0 && !writeFile(leaf + QLatin1String("/memory.max"), QByteArray::number(m_limits.memory))) {
+        QDir().rmdir(leaf);
+        return QString();
+    }
+    return leaf;
+}
+
+// Feed gs through @p input, unless it is -1, closing it when done, and
+// collect what it writes to @p output until it closes it.
+bool GSProcess::communicate(int input, int source, int output, QByteArray *data, const QDeadlineTimer &deadline)
+{
+    char buffer[16384];
+    Feeder feeder(m_input, source, m_ranges);
+
+    pollfd fds[3];
+    fds[0].fd = output;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_cancelPipe[0]; // ignored by poll() if -1
+    fds[1].events = POLLIN;
+    fds[2].fd = input;
+    fds[2].events = POLLOUT;
+
+    bool ok = true;
+    for (;;) {
+        if (fds[2].fd != -1 && feeder.atEnd()) {
+            close(fds[2].fd);
+            fds[2].fd = -1;
+        }
+
+        // -1, waiting forever, if there is no time limit
+        const int ready = poll(fds, 3, deadline.remainingTime());
+        if (ready == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ok = false;
+            break;
+        }
+        if (ready == 0) {
+            ok = false;
+            m_status = TimedOut;
+            break;
+        }
+        if (fds[1].revents) {
+            ok = false;
+            m_status = Cancelled;
+            break;
+        }
+
+        if (fds[2].revents & POLLOUT) {
+            if (!feeder.feed(fds[2].fd)) {
+                ok = false;
+                break;
+            }
+        } else if (fds[2].revents) {
+            // gs stopped reading, what it has may be enough
+            feeder.finish();
+        }
+
+        if (!fds[0].revents) {
+            continue;
+        }
+        const ssize_t count = read(output, buffer, sizeof(buffer));
+        if (count == -1) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            ok = false;
+            break;
+        }
+        if (count == 0) {
+            break; // got all data
+        }
+        data->append(buffer, count);
+    }
+
+    // The caller must not close it again
+    if (fds[2].fd != -1) {
+        close(fds[2].fd);
+    }
+    return ok;
+}
@@ -0,0 +1,254 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _GSPROCESS_H_
+#define _GSPROCESS_H_
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+class QDeadlineTimer;
+class QJsonObject;
+
+/**
+ * Caps on what rendering one thumbnail may cost. Zero means no limit
+ * for all but the timeout, where it is -1.
+ *
+ * Each value can be set under "GhostscriptLimits" in the plugin
+ * metadata and overridden by an environment variable:
+ *
+ *  Timeout      GSTHUMBNAIL_TIMEOUT         whole run, milliseconds
+ *  PdfTimeout   GSTHUMBNAIL_PDF_TIMEOUT     whole run for PDF files
+ *  Cpu          GSTHUMBNAIL_CPU             per child, seconds
+ *  Memory       GSTHUMBNAIL_MEMORY          address space per child, bytes
+ *  FileSize     GSTHUMBNAIL_FILE_SIZE       largest file a child writes, bytes
+ *  OpenFiles    GSTHUMBNAIL_OPEN_FILES      descriptors per child
+ *  MaxBitmap    GSTHUMBNAIL_MAX_BITMAP      gs -dMaxBitmap, bytes
+ *  BufferSpace  GSTHUMBNAIL_BUFFER_SPACE    gs -dBufferSpace, bytes
+ *  RetryAfter   GSTHUMBNAIL_RETRY_AFTER     before rendering a failed document again, seconds
+ *  Cgroup       GSTHUMBNAIL_CGROUP          delegated cgroup v2 directory
+ *
+ * The resource limits are only applied on Linux, where they are set
+ * before gs starts, and a run whose limits cannot be set fails. When a
+ * cgroup is given, each run gets a leaf below it whose memory.max is
+ * Memory, which the children join before gs starts; a run whose leaf
+ * cannot be set up or joined fails too.
+ *
+ * RetryAfter doubles with every failure in a row, up to 64 times, and
+ * 0 always tries again. Failures are remembered in the DSC index, for
+ * documents that are in it.
+ */
+struct GSLimits {
+    int timeout = 20 * 1000;
+    // gs reads the cross-reference table and the resources of a PDF
+    // file before its page
+    int pdfTimeout = 30 * 1000;
+    int cpu = 20;
+    qint64 memory = qint64(1) << 30;
+    qint64 fileSize = qint64(64) << 20;
+    int openFiles = 256;
+    qint64 maxBitmap = qint64(64) << 20;
+    qint64 bufferSpace = 0;
+    int retryAfter = 60 * 60;
+    QString cgroup;
+
+    static GSLimits fromConfig(const QJsonObject &config);
+};
+
+/**
+ * A cheaper rendering for small thumbnails, which do not show image
+ * interpolation, transparency blending or overprint simulation, and
+ * do not need the fonts of the system when gs has a substitute.
+ *
+ * Set under "GhostscriptDraft" in the plugin metadata, and overridden
+ * by environment variables, like GSLimits:
+ *
+ *  MaxSize      GSTHUMBNAIL_DRAFT_SIZE        largest thumbnail drawn as a draft, pixels
+ *  MaxBitmap    GSTHUMBNAIL_DRAFT_MAX_BITMAP  gs -dMaxBitmap for drafts, bytes
+ *
+ * A MaxSize of 0 turns drafts off.
+ */
+struct GSDraftProfile {
+    int maxSize = 256;
+    qint64 maxBitmap = qint64(8) << 20;
+
+    /**
+     * Whether a thumbnail rendered at @p width x @p height is a draft.
+     */
+    bool appliesTo(int width, int height) const;
+
+    /**
+     * The gs options of a draft.
+     */
+    static QList<QByteArray> arguments();
+
+    static GSDraftProfile fromConfig(const QJsonObject &config);
+};
+
+/**
+ * Banded rendering on several threads for large pages, e.g. drawings
+ * rendered for large thumbnails, with the threads taken from a budget
+ * shared by all thumbnail jobs of the user, see RenderThreads.
+ *
+ * Set under "GhostscriptThreads" in the plugin metadata, and overridden
+ * by environment variables, like GSLimits:
+ *
+ *  Budget     GSTHUMBNAIL_THREADS          cores for all jobs, 0 for all cores
+ *  PerJob     GSTHUMBNAIL_THREADS_PER_JOB  most threads one job takes, in all
+ *  MinPixels  GSTHUMBNAIL_THREADED_PIXELS  smallest page rendered on threads
+ *  Shared     GSTHUMBNAIL_THREADS_SHARED   budget file shared with other users
+ *
+ * A MinPixels of 0 keeps every page on one thread.
+ *
+ * A Shared budget has the jobs of several users compete for the same
+ * cores, but whoever may write the file may also lock all of it, and
+ * so keep the jobs of everyone else on one thread. It is only used
+ * when the file exists, which an administrator creates for the users
+ * trusted with it, e.g. owned by a group of them with mode 0660.
+ */
+struct GSThreading {
+    int budget = 0;
+    int perJob = 4;
+    qint64 minPixels = 512 * 1024;
+    QString shared;
+
+    /**
+     * The cores shared by all jobs.
+     */
+    int cores() const;
+
+    /**
+     * How many threads a page of @p width x @p height pixels wants.
+     */
+    int wantedFor(int width, int height) const;
+
+    /**
+     * The gs options to render a page of @p width x @p height pixels in
+     * bands on @p threads threads, and in @p maxBitmap the -dMaxBitmap
+     * below which gs bands it.
+     */
+    static QList<QByteArray> arguments(int threads, int width, int height, qint64 *maxBitmap);
+
+    static GSThreading fromConfig(const QJsonObject &config);
+};
+
+/**
+ * One run of Ghostscript, optionally fed by dvips, for a single
+ * thumbnail request.
+ *
+ * Everything a run needs, from the argument vectors to the pipes, is
+ * owned by the object, and no signal dispositions are touched, so
+ * several runs can go on at the same time in different threads.
+ * cancel() may be called from any thread; it wakes up run() through a
+ * pipe and makes it kill the children.
+ *
+ * The children are started with posix_spawn(). They stop when the
+ * thumbnailer dies, as soon as they write to their broken output pipe.
+ * The input of gs is written as it takes it, while its output is read,
+ * and SIGPIPE is blocked in the calling thread meanwhile, as gs may
+ * quit before having read all of it.
+ */
+class GSProcess
+{
+public:
+    /**
+     * Bytes [begin, end) of a file.
+     */
+    struct Range {
+        qint64 begin;
+        qint64 end;
+    };
+
+    GSProcess();
+    ~GSProcess();
+
+    /**
+     * The gs command line, starting with the program name.
+     */
+    void setArguments(const QList<QByteArray> &arguments);
+
+    /**
+     * Options put before those of setArguments(), e.g. those of
+     * GSDraftProfile.
+     */
+    void setOptions(const QList<QByteArray> &options);
+
+    /**
+     * Render a DVI file: dvips converts it and its output is piped
+     * into gs instead of the input data.
+     */
+    void setDviArguments(const QList<QByteArray> &arguments);
+
+    /**
+     * Data written to the standard input of gs.
+     */
+    void setInput(const QByteArray &input);
+
+    /**
+     * Parts of the file @p fileName written to the standard input of gs
+     * after the input data, in order. They are copied by the kernel
+     * where it can, without passing through this process.
+     */
+    void setInputRanges(const QByteArray &fileName, const QList<Range> &ranges);
+
+    /**
+     * A document gs reads itself as /dev/fd/3 rather than from a file
+     * name, for documents that only exist in memory. The descriptor
+     * stays owned by the caller and must be open during run().
+     */
+    void setDocument(int fd);
+
+    void setLimits(const GSLimits &limits);
+
+    /**
+     * Run the children and collect the standard output of gs.
+     * Returns false on failure, timeout or cancellation.
+     */
+    bool run(QByteArray *output);
+
+    enum Status {
+        // gs exited with 0 or 1, which it also does for some errors
+        Succeeded,
+        // gs exited with another status
+        Failed,
+        TimedOut,
+        // Killed by a signal it was not sent by us
+        Crashed,
+        Cancelled,
+        // The pipes, the children or their limits could not be set up,
+        // e.g. for want of descriptors or with gs not installed
+        NotStarted,
+        // Feeding gs or reading its output failed on our side
+        Error,
+    };
+
+    /**
+     * How the last run() ended.
+     */
+    Status status() const;
+
+    void cancel();
+
+private:
+    Q_DISABLE_COPY(GSProcess)
+
+    bool communicate(int input, int source, int output, QByteArray *data, const QDeadlineTimer &deadline);
+    QString createCgroup() const;
+
+    QList<QByteArray> m_arguments;
+    QList<QByteArray> m_options;
+    QList<QByteArray> m_dviArguments;
+    QByteArray m_input;
+    QByteArray m_rangeFile;
+    QList<Range> m_ranges;
+    int m_document;
+    GSLimits m_limits;
+    Status m_status;
+    int m_cancelPipe[2];
+};
+
+#endif
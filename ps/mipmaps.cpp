@@ -0,0 +1,87 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "mipmaps.h"
+
+#include <iterator>
+
+namespace
+{
+const int buckets[] = {128, 256, 512, 1024};
+
+// Average each 2x2 block. Works on premultiplied pixels, so that
+// transparent pixels do not darken their neighbours.
+QImage halve(const QImage &image)
+{
+    const int width = image.width();
+    const int height = image.height();
+    QImage result(qMax(1, width / 2), qMax(1, height / 2), image.format());
+
+    for (int y = 0; y < result.height(); ++y) {
+        const QRgb *row0 = reinterpret_cast<const QRgb *>(image.constScanLine(2 * y));
+        const QRgb *row1 = reinterpret_cast<const QRgb *>(image.constScanLine(qMin(2 * y + 1, height - 1)));
+        QRgb *out = reinterpret_cast<QRgb *>(result.scanLine(y));
+
+        for (int x = 0; x < result.width(); ++x) {
+            const int x0 = 2 * x;
+            const int x1 = qMin(x0 + 1, width - 1);
+            const QRgb a = row0[x0];
+            const QRgb b = row0[x1];
+            const QRgb c = row1[x0];
+            const QRgb d = row1[x1];
+            out[x] = qRgba((qRed(a) + qRed(b) + qRed(c) + qRed(d) + 2) / 4,
+                           (qGreen(a) + qGreen(b) + qGreen(c) + qGreen(d) + 2) / 4,
+                           (qBlue(a) + qBlue(b) + qBlue(c) + qBlue(d) + 2) / 4,
+                           (qAlpha(a) + qAlpha(b) + qAlpha(c) + qAlpha(d) + 2) / 4);
+        }
+    }
+
+    return result;
+}
+}
+
+int Mipmaps::bucketFor(int size)
+{
+    for (int bucket : buckets) {
+        if (size <= bucket) {
+            return bucket;
+        }
+    }
+    return buckets[std::size(buckets) - 1];
+}
+
+QList<QImage> Mipmaps::build(const QImage &image, int largest)
+{
+    QList<QImage> chain;
+    if (image.isNull()) {
+        return chain;
+    }
+
+    QImage level = image;
+    if (level.width() > largest || level.height() > largest) {
+        level = level.scaled(largest, largest, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    level = level.convertToFormat(level.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    chain.append(level);
+
+    while (qMax(level.width(), level.height()) / 2 >= buckets[0]) {
+        level = halve(level);
+        chain.append(level);
+    }
+
+    return chain;
+}
+
+QImage Mipmaps::pick(const QList<QImage> &chain, const QSize &target)
+{
+    const int wanted = qMax(target.width(), target.height());
+    for (auto it = chain.crbegin(); it != chain.crend(); ++it) {
+        if (qMax(it->width(), it->height()) >= wanted) {
+            return *it;
+        }
+    }
+    return chain.isEmpty() ? QImage() : chain.first();
+}
@@ -0,0 +1,39 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _MIPMAPS_H_
+#define _MIPMAPS_H_
+
+#include <QImage>
+#include <QList>
+#include <QSize>
+
+/**
+ * Helpers for building one thumbnail per freedesktop.org cache bucket
+ * (normal 128, large 256, x-large 512 and xx-large 1024) from a single
+ * rendering.
+ */
+namespace Mipmaps
+{
+/**
+ * The smallest bucket which holds @p size, or the largest bucket.
+ */
+int bucketFor(int size);
+
+/**
+ * Fit @p image into @p largest pixels, then halve it with a box filter
+ * until the next level would be smaller than the normal bucket.
+ * The chain is returned largest first.
+ */
+QList<QImage> build(const QImage &image, int largest);
+
+/**
+ * The smallest level of @p chain which still covers @p target.
+ */
+QImage pick(const QList<QImage> &chain, const QSize &target);
+}
+
+#endif
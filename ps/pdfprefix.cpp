@@ -0,0 +1,247 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "pdfprefix.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <QFile>
+#include <QMap>
+#include <QRegularExpression>
+
+#if defined(Q_OS_LINUX)
+#include <sys/mman.h>
+#include <sys/vfs.h>
+#endif
+
+#include <utility>
+
+namespace
+{
+// Larger first pages are read by gs from the original file
+const qint64 maxPrefixLength = qint64(64) << 20;
+
+// The largest object number PDF allows. The trailer gives the number
+// after the last object as the size of the table, which gs may
+// allocate entries for.
+const qint64 maxObjectNumber = 8388607;
+
+// The value of an integer entry of a dictionary, or -1
+qint64 entry(const QString &dictionary, const char *key)
+{
+    const QRegularExpression pattern(QStringLiteral("/%1\\s+(\\d+)").arg(QLatin1String(key)));
+    const QRegularExpressionMatch match = pattern.match(dictionary);
+    return match.hasMatch() ? match.captured(1).toLongLong() : -1;
+}
+
+// The text of object @p offset starts at, up to its endobj
+QString objectAt(const QString &text, qint64 offset)
+{
+    const qsizetype end = text.indexOf(QLatin1String("endobj"), offset);
+    return end == -1 ? QString() : text.mid(offset, end - offset);
+}
+
+bool writeAll(int fd, const QByteArray &data)
+{
+    const char *p = data.constData();
+    qsizetype left = data.size();
+    while (left > 0) {
+        const ssize_t count = write(fd, p, left);
+        if (count == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += count;
+        left -= count;
+    }
+    return true;
+}
+}
+
+bool PDFPrefix::isWanted(const QString &path)
+{
+    bool set = false;
+    const int wanted = qEnvironmentVariableIntValue("GSTHUMBNAIL_PDF_PREFIX", &set);
+    if (set) {
+        return wanted > 0;
+    }
+
+#if defined(Q_OS_LINUX)
+    struct statfs fs;
+    if (statfs(QFile::encodeName(path).constData(), &fs) != 0) {
+        return false;
+    }
+    switch (static_cast<quint32>(fs.f_type)) {
+    case 0x6969: // NFS
+    case 0x517b: // SMB
+    case 0xff534d42: // CIFS
+    case 0xfe534d42: // SMB2
+    case 0x65735546: // FUSE: sshfs, gvfs, ...
+    case 0x00c36400: // Ceph
+    case 0x01021997: // 9P
+        return true;
+    default:
+        return false;
+    }
+#else
+    Q_UNUSED(path);
+    return false;
+#endif
+}
+
+PDFPrefix::PDFPrefix(const QString &path, int mediaWidth, int mediaHeight)
+    : m_fd(-1)
+{
+    if (!build(path, mediaWidth, mediaHeight) && m_fd != -1) {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+PDFPrefix::~PDFPrefix()
+{
+    if (m_fd != -1) {
+        close(m_fd);
+    }
+}
+
+bool PDFPrefix::isValid() const
+{
+    return m_fd != -1;
+}
+
+int PDFPrefix::fd() const
+{
+    return m_fd;
+}
+
+bool PDFPrefix::build(const QString &path, int mediaWidth, int mediaHeight)
+{
+#if defined(Q_OS_LINUX)
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // The linearization dictionary is the first object of the file
+    const QString head = QString::fromLatin1(file.peek(1024));
+    const qsizetype linearized = head.indexOf(QLatin1String("/Linearized"));
+    if (linearized == -1) {
+        return false;
+    }
+    const qsizetype dictionaryBegin = head.lastIndexOf(QLatin1String("<<"), linearized);
+    const qsizetype dictionaryEnd = head.indexOf(QLatin1String(">>"), linearized);
+    if (dictionaryBegin == -1 || dictionaryEnd == -1) {
+        return false;
+    }
+    const QString dictionary = head.mid(dictionaryBegin, dictionaryEnd - dictionaryBegin);
+    const qint64 length = entry(dictionary, "L");
+    const qint64 firstPageEnd = entry(dictionary, "E");
+    const qint64 firstPage = entry(dictionary, "O");
+
+    // A different length means the file was updated afterwards, and
+    // the prefix may no longer hold the first page
+    if (length != file.size() || firstPageEnd <= dictionaryEnd || firstPageEnd > length || firstPageEnd > maxPrefixLength || firstPage <= 0) {
+        return false;
+    }
+
+    // One sequential read
+    QByteArray prefix = file.read(firstPageEnd);
+    if (prefix.size() != firstPageEnd) {
+        return false;
+    }
+    const QString text = QString::fromLatin1(prefix);
+
+    // The first-page cross-reference section must be a table, whose
+    // trailer tells where the catalog is
+    const qsizetype trailer = text.indexOf(QLatin1String("trailer"), dictionaryEnd);
+    const qsizetype startxref = text.indexOf(QLatin1String("startxref"), qMax<qsizetype>(trailer, 0));
+    static const QRegularExpression xrefPattern(QStringLiteral("(?<![A-Za-z])xref\\s"));
+    const qsizetype xref = text.indexOf(xrefPattern, dictionaryEnd);
+    if (trailer == -1 || startxref == -1 || xref == -1 || xref > trailer) {
+        return false;
+    }
+    const QString trailerDictionary = text.mid(trailer, startxref - trailer);
+    const qint64 root = entry(trailerDictionary, "Root");
+    if (root <= 0 || trailerDictionary.contains(QLatin1String("/Encrypt"))) {
+        return false;
+    }
+
+    // Offset and generation of the objects of the prefix, the last
+    // definition of each wins
+    QMap<qint64, std::pair<qint64, int>> objects;
+    static const QRegularExpression objectPattern(QStringLiteral("(?<=[\\r\\n])(\\d+)\\s+(\\d+)\\s+obj(?![A-Za-z])"));
+    QRegularExpressionMatchIterator it = objectPattern.globalMatch(text);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        objects.insert(match.captured(1).toLongLong(), {match.capturedStart(1), match.captured(2).toInt()});
+    }
+    if (!objects.contains(root) || !objects.contains(firstPage)) {
+        return false;
+    }
+
+    const qint64 pages = entry(objectAt(text, objects.value(root).first), "Pages");
+    const qint64 parent = entry(objectAt(text, objects.value(firstPage).first), "Parent");
+    if (pages <= 0) {
+        return false;
+    }
+
+    // The page tree is not part of the first page section: make up one
+    // holding the first page only
+    QByteArray tail = "\n";
+    const auto addObject = [&](qint64 number, const QByteArray &body) {
+        objects.insert(number, {prefix.size() + tail.size(), 0});
+        tail += QByteArray::number(number) + " 0 obj\n" + body + "\nendobj\n";
+    };
+    const QByteArray mediaBox = mediaWidth > 0 && mediaHeight > 0
+        ? " /MediaBox [0 0 " + QByteArray::number(mediaWidth) + ' ' + QByteArray::number(mediaHeight) + ']'
+        : QByteArray();
+    const bool intermediate = parent > 0 && parent != pages;
+    if (intermediate && !objects.contains(parent)) {
+        addObject(parent, "<< /Type /Pages /Parent " + QByteArray::number(pages) + " 0 R /Kids [" + QByteArray::number(firstPage) + " 0 R] /Count 1 >>");
+    }
+    if (!objects.contains(pages)) {
+        addObject(pages, "<< /Type /Pages /Kids [" + QByteArray::number(intermediate ? parent : firstPage) + " 0 R] /Count 1" + mediaBox + " >>");
+    }
+
+    // Object 0 is the head of the free list
+    if (objects.firstKey() <= 0 || objects.lastKey() > maxObjectNumber) {
+        return false;
+    }
+
+    // A cross-reference table for all of it, which is the one gs reads
+    // first, as the last in the file. Its subsections cover the objects
+    // that exist only, whatever numbers the file gives them.
+    const qint64 xrefOffset = prefix.size() + tail.size();
+    const qint64 size = objects.lastKey() + 1;
+    tail += "xref\n0 1\n0000000000 65535 f\r\n";
+    for (auto object = objects.cbegin(); object != objects.cend();) {
+        auto end = object;
+        qint64 next = object.key();
+        while (end != objects.cend() && end.key() == next) {
+            ++end;
+            ++next;
+        }
+        tail += QByteArray::number(object.key()) + ' ' + QByteArray::number(next - object.key()) + '\n';
+        for (; object != end; ++object) {
+            tail += QByteArray::number(object->first).rightJustified(10, '0') + ' ' + QByteArray::number(object->second).rightJustified(5, '0') + " n\r\n";
+        }
+    }
+    tail += "trailer\n<< /Size " + QByteArray::number(size) + " /Root " + QByteArray::number(root) + " 0 R >>\nstartxref\n" + QByteArray::number(xrefOffset)
+        + "\n%%EOF\n";
+
+    m_fd = memfd_create("gsthumbnail-pdf", MFD_CLOEXEC);
+    return m_fd != -1 && writeAll(m_fd, prefix) && writeAll(m_fd, tail);
+#else
+    Q_UNUSED(path);
+    Q_UNUSED(mediaWidth);
+    Q_UNUSED(mediaHeight);
+    return false;
+#endif
+}
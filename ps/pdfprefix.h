@@ -0,0 +1,58 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _PDFPREFIX_H_
+#define _PDFPREFIX_H_
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * The first page of a linearized ("fast web view") PDF file, as a
+ * PDF file of its own in memory.
+ *
+ * A linearized file starts with everything its first page needs, up
+ * to the offset given as /E in its linearization dictionary. That
+ * prefix is read in one sequential pass, and a page tree and a
+ * cross-reference table for the objects found in it are appended, so
+ * that gs renders the page without seeking all over the original file,
+ * which is slow on network file systems.
+ *
+ * Only files with a classic cross-reference table, which are neither
+ * encrypted nor updated since they were linearized, are taken. Others
+ * leave the prefix invalid, and gs should be given the original file.
+ */
+class PDFPrefix
+{
+public:
+    /**
+     * Whether to use the prefix of files at @p path: when they are on
+     * a network file system, unless GSTHUMBNAIL_PDF_PREFIX says to
+     * always (1) or never (0) do it.
+     */
+    static bool isWanted(const QString &path);
+
+    /**
+     * @p mediaWidth and @p mediaHeight, in points, give the page tree a
+     * media box in case the page inherits it from the one left out.
+     */
+    PDFPrefix(const QString &path, int mediaWidth, int mediaHeight);
+    ~PDFPrefix();
+
+    bool isValid() const;
+
+    /**
+     * A close-on-exec descriptor of the prefix document.
+     */
+    int fd() const;
+
+private:
+    bool build(const QString &path, int mediaWidth, int mediaHeight);
+
+    int m_fd;
+};
+
+#endif
@@ -0,0 +1,169 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "photoshopthumbnail.h"
+
+#include <string.h>
+
+#include <QBuffer>
+#include <QFile>
+#include <QImageReader>
+#include <QtEndian>
+
+namespace
+{
+// Larger blocks are not the image resources of an EPS file
+const qint64 maxBlockLength = 4 * 1024 * 1024;
+
+const quint16 thumbnailResource = 1036;
+const quint16 oldThumbnailResource = 1033;
+
+// Format, width, height, row bytes, total size, compressed size, bits
+// per pixel and planes, before the JPEG data
+const int thumbnailHeaderLength = 28;
+
+// Maps hex digits to their values and every other byte to 0x80
+struct HexTable {
+    uchar values[256];
+
+    constexpr HexTable()
+        : values()
+    {
+        for (int i = 0; i < 256; ++i) {
+            values[i] = 0x80;
+        }
+        for (int i = 0; i < 10; ++i) {
+            values['0' + i] = i;
+        }
+        for (int i = 0; i < 6; ++i) {
+            values['a' + i] = 10 + i;
+            values['A' + i] = 10 + i;
+        }
+    }
+};
+
+constexpr HexTable hex;
+
+QImage decodeImage(const QByteArray &jpeg, const QSize &size)
+{
+    QBuffer buffer;
+    buffer.setData(jpeg);
+    if (!buffer.open(QIODevice::ReadOnly)) {
+        return QImage();
+    }
+
+    QImageReader reader(&buffer, "jpeg");
+    const QSize full = reader.size();
+    if (full.isValid() && (full.width() > size.width() || full.height() > size.height())) {
+        reader.setScaledSize(full.scaled(size, Qt::KeepAspectRatio));
+    }
+    QImage image;
+    if (!reader.read(&image)) {
+        return QImage();
+    }
+    return image;
+}
+}
+
+QImage PhotoshopThumbnail::fromResources(const QByteArray &resources, const QSize &size)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(resources.constData());
+    const uchar *end = p + resources.size();
+
+    // 8BIM, id, name as an even-sized Pascal string, size and data
+    // padded to an even size, all big-endian
+    QByteArray jpeg;
+    bool swapped = false;
+    while (end - p >= 12 && memcmp(p, "8BIM", 4) == 0) {
+        const quint16 id = qFromBigEndian<quint16>(p + 4);
+        const qsizetype nameLength = (1 + p[6] + 1) & ~1;
+        if (end - p < 6 + nameLength + 4) {
+            break;
+        }
+        const uchar *data = p + 6 + nameLength + 4;
+        const quint32 length = qFromBigEndian<quint32>(data - 4);
+        if (length > quint32(end - data)) {
+            break;
+        }
+
+        if ((id == thumbnailResource || (id == oldThumbnailResource && jpeg.isEmpty())) && length > thumbnailHeaderLength) {
+            jpeg = QByteArray(reinterpret_cast<const char *>(data) + thumbnailHeaderLength, length - thumbnailHeaderLength);
+            swapped = id == oldThumbnailResource;
+        }
+        p = data + qMin<qsizetype>((length + 1) & ~1U, end - data);
+    }
+
+    if (jpeg.isEmpty()) {
+        return QImage();
+    }
+    const QImage image = decodeImage(jpeg, size);
+    return swapped ? image.rgbSwapped() : image;
+}
+
+QImage PhotoshopThumbnail::fromFile(const QString &path, qint64 begin, qint64 end, const QSize &size)
+{
+    if (begin <= 0 || end <= begin || end - begin > maxBlockLength) {
+        return QImage();
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(begin)) {
+        return QImage();
+    }
+    QByteArray block = file.read(end - begin);
+
+    // Only the lines in between hold resources. Files of classic Mac OS
+    // end their lines with a bare CR.
+    qsizetype first = 0;
+    while (first < block.size() && block.at(first) != '\r' && block.at(first) != '\n') {
+        ++first;
+    }
+    if (first + 1 < block.size() && block.at(first) == '\r' && block.at(first + 1) == '\n') {
+        ++first;
+    }
+    const qsizetype last = block.lastIndexOf("%EndPhotoshop");
+    if (first == block.size() || last <= first) {
+        return QImage();
+    }
+    block = block.mid(first + 1, last - first - 1);
+
+    bool ok = false;
+    const QByteArray resources = decodeHex(block, &ok);
+    return ok ? fromResources(resources, size) : QImage();
+}
+
+QByteArray PhotoshopThumbnail::decodeHex(const QByteArray &text, bool *ok)
+{
+    *ok = false;
+
+    // Gather the digits first, dropping the % starting each line and
+    // white space
+    QByteArray digits(text.size(), Qt::Uninitialized);
+    uchar *digit = reinterpret_cast<uchar *>(digits.data());
+    qsizetype count = 0;
+    for (const char c : text) {
+        const uchar value = hex.values[static_cast<uchar>(c)];
+        if (value < 16) {
+            digit[count++] = c;
+        } else if (c != '%' && c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            return QByteArray();
+        }
+    }
+    if (count % 2) {
+        return QByteArray();
+    }
+
+    // Pairs of digits, with neither branches nor state carried from one
+    // byte to the next, so that the compiler can vectorize the loop
+    QByteArray result(count / 2, Qt::Uninitialized);
+    uchar *out = reinterpret_cast<uchar *>(result.data());
+    for (qsizetype i = 0; i < count / 2; ++i) {
+        out[i] = (hex.values[digit[2 * i]] << 4) | hex.values[digit[2 * i + 1]];
+    }
+
+    *ok = true;
+    return result;
+}
@@ -0,0 +1,42 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _PHOTOSHOPTHUMBNAIL_H_
+#define _PHOTOSHOPTHUMBNAIL_H_
+
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+/**
+ * The thumbnail Photoshop stores among the image resources of the EPS
+ * files it writes, hex encoded between %BeginPhotoshop: and
+ * %EndPhotoshop comments: a JPEG image in resource 1036, or in
+ * resource 1033 with red and blue swapped for files of Photoshop 4.
+ */
+namespace PhotoshopThumbnail
+{
+/**
+ * The thumbnail in the image resources @p resources, scaled down to fit
+ * @p size while it is decoded, or a null image.
+ */
+QImage fromResources(const QByteArray &resources, const QSize &size);
+
+/**
+ * The thumbnail in the %BeginPhotoshop: block between the offsets
+ * @p begin and @p end of the file at @p path, as found by KDSC.
+ */
+QImage fromFile(const QString &path, qint64 begin, qint64 end, const QSize &size);
+
+/**
+ * Decode the hex digits of the comment lines of a %BeginPhotoshop:
+ * block, without the %BeginPhotoshop: and %EndPhotoshop lines.
+ */
+QByteArray decodeHex(const QByteArray &text, bool *ok);
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "renderthreads.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+
+#include <atomic>
+
+namespace
+{
+#if defined(F_OFD_SETLK)
+// The budget of this user alone, unless @p shared names a file that
+// several users were given. Any user who may write that file may take
+// all of it, which is why it is never created here.
+int openBudget(const QString &shared)
+{
+    const int flags = O_RDWR | O_CLOEXEC | O_NOFOLLOW;
+    if (!shared.isEmpty()) {
+        const int fd = open(QFile::encodeName(shared).constData(), flags);
+        if (fd != -1) {
+            return fd;
+        }
+    }
+
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (dir.isEmpty()) {
+        return -1;
+    }
+    const QByteArray path = QFile::encodeName(QDir(dir).filePath(QStringLiteral("kdegraphics-thumbnailers-threads")));
+    return open(path.constData(), flags | O_CREAT, 0600);
+}
+
+// Open file description locks belong to the descriptor, which keeps
+// the jobs of one process, e.g. of the batch thumbnailer, apart
+bool lockByte(int fd, int byte)
+{
+    struct flock lock = {};
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = byte;
+    lock.l_len = 1;
+    return fcntl(fd, F_OFD_SETLK, &lock) == 0;
+}
+#else
+// Other systems share their record locks between the threads of a
+// process, which would let its jobs take the same cores. The budget is
+// then one of this process alone.
+std::atomic<int> usedThreads(0);
+#endif
+}
+
+RenderThreads::RenderThreads(int budget, int wanted, const QString &shared)
+    : m_fd(-1)
+    , m_count(0)
+{
+#if defined(F_OFD_SETLK)
+    m_fd = openBudget(shared);
+    if (m_fd == -1) {
+        return;
+    }
+    for (int byte = 0; byte < budget && m_count < wanted; ++byte) {
+        if (lockByte(m_fd, byte)) {
+            ++m_count;
+        }
+    }
+#else
+    Q_UNUSED(shared);
+    int used = usedThreads.load();
+    do {
+        m_count = qBound(0, budget - used, wanted);
+    } while (m_count > 0 && !usedThreads.compare_exchange_weak(used, used + m_count));
+#endif
+}
+
+RenderThreads::~RenderThreads()
+{
+#if defined(F_OFD_SETLK)
+    if (m_fd != -1) {
+        close(m_fd);
+    }
+#else
+    usedThreads -= m_count;
+#endif
+}
+
+int RenderThreads::count() const
+{
+    return qMax(1, m_count);
+}
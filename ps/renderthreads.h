@@ -0,0 +1,52 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _RENDERTHREADS_H_
+#define _RENDERTHREADS_H_
+
+#include <QString>
+
+/**
+ * A share of the cores of the machine, held while gs renders.
+ *
+ * The budget is a lock file in the runtime directory of the user, each
+ * of whose first @c budget bytes is one core. Every thumbnail job of
+ * every thumbnailer process locks one byte while it runs, and a job
+ * that wants several threads locks as many as are free, up to the count
+ * it wants, its own included, so that it gets the cores the other jobs
+ * leave idle and no more. The locks are open file description locks,
+ * which go with the descriptor, also when a process is killed. Without
+ * open file description locks, the budget is a counter of the process.
+ *
+ * A shared file, set up by an administrator for several users, makes
+ * the budget theirs together; see GSThreading for what that trusts
+ * them with. It is never created here, and when it cannot be opened,
+ * the budget is of the user alone again.
+ *
+ * Nothing ever waits: a job that finds the budget used up still runs,
+ * with one thread.
+ */
+class RenderThreads
+{
+public:
+    /**
+     * Take up to @p wanted of @p budget cores, in all, of the budget in
+     * the file @p shared if it is set.
+     */
+    RenderThreads(int budget, int wanted, const QString &shared = QString());
+    ~RenderThreads();
+
+    /**
+     * How many threads to render with, at least 1.
+     */
+    int count() const;
+
+private:
+    int m_fd;
+    int m_count;
+};
+
+#endif
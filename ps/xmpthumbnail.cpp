@@ -0,0 +1,423 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "xmpthumbnail.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QImageReader>
+#include <QRegularExpression>
+
+#include <utility>
+
+namespace
+{
+// How much of each end of a file is read at first
+const qint64 xmpReadLength = 1024 * 1024;
+
+// Bounds on what is read of a PDF file beyond that
+const qint64 maxMetadataLength = qint64(4) << 20;
+const qint64 dictionaryReadLength = 4096;
+const qint64 xrefReadLength = 64 * 1024;
+const int maxXrefSections = 16;
+
+// How much of a PostScript header is searched at most
+const qint64 maxHeaderLength = qint64(16) << 20;
+
+// Maps the base64 alphabet to the values of its digits and every other
+// byte to 0x80
+struct Base64Table {
+    uchar values[256];
+
+    constexpr Base64Table()
+        : values()
+    {
+        const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < 256; ++i) {
+            values[i] = 0x80;
+        }
+        for (int i = 0; i < 64; ++i) {
+            values[static_cast<uchar>(alphabet[i])] = i;
+        }
+    }
+};
+
+constexpr Base64Table base64;
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// The first xmpGImg:image value, written as an element or as an
+// attribute, in the XMP packets of @p data. A packet cut off by the end
+// of @p data is searched up to there.
+//
+// Files with placed or embedded art carry the packets of those too,
+// after the one of the document itself, so the first thumbnail is
+// taken rather than the largest.
+QByteArray firstImage(const QByteArray &data)
+{
+    const QByteArray name = QByteArrayLiteral("xmpGImg:image");
+
+    qsizetype begin = 0;
+    while ((begin = data.indexOf("<?xpacket begin", begin)) != -1) {
+        qsizetype end = data.indexOf("<?xpacket end", begin);
+        if (end == -1) {
+            end = data.size();
+        }
+
+        qsizetype at = begin;
+        while ((at = data.indexOf(name, at)) != -1 && at < end) {
+            const bool closing = at > 0 && data.at(at - 1) == '/';
+            at += name.size();
+            if (closing) {
+                continue;
+            }
+
+            qsizetype value = at;
+            while (value < end && isSpace(data.at(value))) {
+                ++value;
+            }
+            char delimiter;
+            if (value < end && data.at(value) == '>') {
+                delimiter = '<';
+            } else if (value < end && data.at(value) == '=') {
+                ++value;
+                while (value < end && isSpace(data.at(value))) {
+                    ++value;
+                }
+                if (value == end || (data.at(value) != '"' && data.at(value) != '\'')) {
+                    continue;
+                }
+                delimiter = data.at(value);
+            } else {
+                continue;
+            }
+            ++value;
+
+            const qsizetype valueEnd = data.indexOf(delimiter, value);
+            if (valueEnd == -1 || valueEnd > end) {
+                break;
+            }
+            if (valueEnd > value) {
+                return data.mid(value, valueEnd - value);
+            }
+            at = valueEnd;
+        }
+
+        begin = end;
+    }
+
+    return QByteArray();
+}
+
+// Random access to a PDF file through the windows read at its head and,
+// if allowed, its tail. Reads outside of them seek in the file, unless
+// @c seekable is off, when they fail.
+struct PDFFile {
+    QFile file;
+    QByteArray head;
+    QByteArray tail;
+    qint64 tailOffset = 0;
+    bool seekable = false;
+
+    QByteArray read(qint64 offset, qint64 length)
+    {
+        length = qMin(length, file.size() - offset);
+        if (offset < 0 || length <= 0) {
+            return QByteArray();
+        }
+        if (offset + length <= head.size()) {
+            return head.mid(offset, length);
+        }
+        if (!tail.isEmpty() && offset >= tailOffset) {
+            return tail.mid(offset - tailOffset, length);
+        }
+        if (!seekable || !file.seek(offset)) {
+            return QByteArray();
+        }
+        return file.read(length);
+    }
+};
+
+// The object number and generation of the reference an entry @p key of
+// @p text holds, the last one if there are several, or -1
+std::pair<qint64, int> reference(const QString &text, const char *key)
+{
+    const QRegularExpression pattern(QStringLiteral("/%1\\s+(\\d+)\\s+(\\d+)\\s+R(?![A-Za-z])").arg(QLatin1String(key)));
+    std::pair<qint64, int> result(-1, 0);
+    QRegularExpressionMatchIterator it = pattern.globalMatch(text);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        result = {match.captured(1).toLongLong(), match.captured(2).toInt()};
+    }
+    return result;
+}
+
+// Where object @p number is defined in the file, looked for in the
+// windows first, the tail winning as the later update, then in the
+// chain of classic cross-reference tables from @p startxref. Objects
+// in object streams, and files with cross-reference streams, are not
+// found that way.
+qint64 objectOffset(PDFFile &pdf, qint64 number, int generation, qint64 startxref)
+{
+    const QRegularExpression pattern(QStringLiteral("(?<![0-9])%1\\s+%2\\s+obj(?![A-Za-z])").arg(number).arg(generation));
+    const auto lastIn = [&pattern](const QByteArray &window) {
+        qsizetype found = -1;
+        QRegularExpressionMatchIterator it = pattern.globalMatch(QString::fromLatin1(window));
+        while (it.hasNext()) {
+            found = it.next().capturedStart();
+        }
+        return found;
+    };
+    if (const qsizetype found = lastIn(pdf.tail); found != -1) {
+        return pdf.tailOffset + found;
+    }
+    if (const qsizetype found = lastIn(pdf.head); found != -1) {
+        return found;
+    }
+
+    static const QRegularExpression subsectionPattern(QStringLiteral("^(\\d+)\\s+(\\d+)\\s*$"));
+    static const QRegularExpression previousPattern(QStringLiteral("/Prev\\s+(\\d+)"));
+    qint64 xref = startxref;
+    for (int section = 0; section < maxXrefSections && xref > 0; ++section) {
+        qint64 base = xref;
+        QByteArray text = pdf.read(base, xrefReadLength);
+        if (!text.startsWith("xref")) {
+            return -1;
+        }
+
+        // Subsections of fixed 20 byte entries, up to the trailer. The
+        // entries of other objects are skipped, reading on from after
+        // them when they go past what was read.
+        qsizetype line = 4;
+        for (;;) {
+            while (line < text.size() && isSpace(text.at(line))) {
+                ++line;
+            }
+            if (line > 0 && line + 64 > text.size() && base + line < pdf.file.size()) {
+                base += line;
+                text = pdf.read(base, xrefReadLength);
+                line = 0;
+            }
+            if (text.mid(line, 7) == "trailer") {
+                break;
+            }
+            const qsizetype lineEnd = text.indexOf('\n', line);
+            if (lineEnd == -1) {
+                return -1;
+            }
+            const QRegularExpressionMatch match = subsectionPattern.match(QString::fromLatin1(text.mid(line, lineEnd - line)));
+            if (!match.hasMatch()) {
+                return -1;
+            }
+            // No more entries than the file has room for, which keeps
+            // the arithmetic on them from overflowing
+            const qint64 entries = pdf.file.size() / 20;
+            bool firstOk = false;
+            bool countOk = false;
+            const qint64 first = match.captured(1).toLongLong(&firstOk);
+            const qint64 count = match.captured(2).toLongLong(&countOk);
+            if (!firstOk || !countOk || first > entries || count > entries) {
+                return -1;
+            }
+            if (number >= first && number < first + count) {
+                const QByteArray entry = pdf.read(base + lineEnd + 1 + (number - first) * 20, 20);
+                if (entry.size() == 20 && entry.at(17) == 'n') {
+                    return entry.left(10).toLongLong();
+                }
+                return -1;
+            }
+            line = lineEnd + 1 + count * 20;
+        }
+
+        const qint64 previous = previousPattern.match(QString::fromLatin1(text.mid(line, xrefReadLength / 16))).captured(1).toLongLong();
+        xref = previous != xref ? previous : 0;
+    }
+    return -1;
+}
+
+// The data of the uncompressed stream object @p offset starts at
+QByteArray streamAt(PDFFile &pdf, qint64 offset)
+{
+    const QByteArray object = pdf.read(offset, dictionaryReadLength);
+    const qsizetype stream = object.indexOf("stream");
+    if (stream == -1) {
+        return QByteArray();
+    }
+    const QString dictionary = QString::fromLatin1(object.left(stream));
+    if (dictionary.contains(QLatin1String("/Filter"))) {
+        return QByteArray();
+    }
+
+    qint64 begin = offset + stream + 6;
+    if (object.mid(stream + 6, 2) == "\r\n") {
+        begin += 2;
+    } else if (object.mid(stream + 6, 1) == "\n") {
+        begin += 1;
+    }
+
+    // The length is often an indirect object, then the packet ends the
+    // read anyway
+    static const QRegularExpression lengthPattern(QStringLiteral("/Length\\s+(\\d+)(?![0-9])(?!\\s+\\d+\\s+R)"));
+    const QRegularExpressionMatch length = lengthPattern.match(dictionary);
+    return pdf.read(begin, length.hasMatch() ? qMin(length.captured(1).toLongLong(), maxMetadataLength) : maxMetadataLength);
+}
+
+// The JPEG decoder scales by 1/2, 1/4 or 1/8 on the fly, so a large
+// thumbnail costs little more than one of the size wanted
+QImage decodeImage(const QByteArray &value, const QSize &size)
+{
+    bool ok = false;
+    QBuffer buffer;
+    buffer.setData(XMPThumbnail::decodeBase64(value, &ok));
+    if (!ok || !buffer.open(QIODevice::ReadOnly)) {
+        return QImage();
+    }
+
+    QImageReader reader(&buffer);
+    const QSize full = reader.size();
+    if (full.isValid() && (full.width() > size.width() || full.height() > size.height())) {
+        reader.setScaledSize(full.scaled(size, Qt::KeepAspectRatio));
+    }
+    QImage image;
+    if (!reader.read(&image)) {
+        return QImage();
+    }
+    return image;
+}
+}
+
+QImage XMPThumbnail::fromData(const QByteArray &data, const QSize &size)
+{
+    const QByteArray value = firstImage(data);
+    return value.isEmpty() ? QImage() : decodeImage(value, size);
+}
+
+QImage XMPThumbnail::fromPostScript(const QString &path, qint64 headerEnd, const QSize &size)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QImage();
+    }
+    return fromData(file.read(headerEnd > 0 ? qMin(headerEnd, maxHeaderLength) : xmpReadLength), size);
+}
+
+QImage XMPThumbnail::fromPDF(const QString &path, bool readTail, const QSize &size)
+{
+    PDFFile pdf;
+    pdf.file.setFileName(path);
+    if (!pdf.file.open(QIODevice::ReadOnly)) {
+        return QImage();
+    }
+    const qint64 length = pdf.file.size();
+    pdf.head = pdf.file.read(xmpReadLength);
+    if (readTail && length > pdf.head.size()) {
+        pdf.tailOffset = qMax<qint64>(pdf.head.size(), length - xmpReadLength);
+        if (!pdf.file.seek(pdf.tailOffset)) {
+            return QImage();
+        }
+        pdf.tail = pdf.file.read(length - pdf.tailOffset);
+    }
+    pdf.seekable = readTail;
+
+    // The last trailer, or cross-reference stream, names the catalog;
+    // that of the first page section of a linearized file is at the head
+    const QByteArray &end = pdf.tail.isEmpty() ? pdf.head : pdf.tail;
+    const QString endText = QString::fromLatin1(end.right(xrefReadLength));
+    std::pair<qint64, int> root = reference(endText, "Root");
+    if (root.first <= 0) {
+        root = reference(QString::fromLatin1(pdf.head.left(xrefReadLength)), "Root");
+    }
+    if (root.first <= 0 || endText.contains(QLatin1String("/Encrypt"))) {
+        return QImage();
+    }
+    static const QRegularExpression startxrefPattern(QStringLiteral("startxref\\s+(\\d+)"));
+    qint64 startxref = 0;
+    QRegularExpressionMatchIterator it = startxrefPattern.globalMatch(endText);
+    while (it.hasNext()) {
+        startxref = it.next().captured(1).toLongLong();
+    }
+
+    // Its /Metadata stream holds the packet of the document, and those
+    // of the pages and images are left alone
+    const qint64 catalog = objectOffset(pdf, root.first, root.second, startxref);
+    if (catalog == -1) {
+        return QImage();
+    }
+    const QByteArray catalogText = pdf.read(catalog, dictionaryReadLength);
+    const qsizetype catalogEnd = catalogText.indexOf("endobj");
+    const std::pair<qint64, int> metadata = reference(QString::fromLatin1(catalogText.left(catalogEnd)), "Metadata");
+    if (metadata.first <= 0) {
+        return QImage();
+    }
+    const qint64 stream = objectOffset(pdf, metadata.first, metadata.second, startxref);
+    return stream == -1 ? QImage() : fromData(streamAt(pdf, stream), size);
+}
+
+QByteArray XMPThumbnail::decodeBase64(const QByteArray &text, bool *ok)
+{
+    *ok = false;
+
+    // Gather the digits first, dropping white space and the character
+    // references of line breaks
+    QByteArray digits(text.size(), Qt::Uninitialized);
+    uchar *digit = reinterpret_cast<uchar *>(digits.data());
+    qsizetype count = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const uchar c = text.at(i);
+        if (base64.values[c] < 64) {
+            digit[count++] = c;
+        } else if (c == '&') {
+            i = text.indexOf(';', i);
+            if (i == -1) {
+                return QByteArray();
+            }
+        } else if (c == '=') {
+            break;
+        } else if (!isSpace(c)) {
+            return QByteArray();
+        }
+    }
+    if (count % 4 == 1) {
+        return QByteArray();
+    }
+
+    const qsizetype groups = count / 4;
+    const qsizetype left = count % 4;
+    QByteArray result(groups * 3 + (left ? left - 1 : 0), Qt::Uninitialized);
+    const uchar *in = digit;
+    uchar *out = reinterpret_cast<uchar *>(result.data());
+
+    // Whole groups of four digits, with neither branches nor state
+    // carried from one group to the next, so that the compiler can
+    // vectorize the loop
+    for (qsizetype group = 0; group < groups; ++group) {
+        const quint32 bits = (quint32(base64.values[in[0]]) << 18) | (quint32(base64.values[in[1]]) << 12)
+            | (quint32(base64.values[in[2]]) << 6) | quint32(base64.values[in[3]]);
+        out[0] = bits >> 16;
+        out[1] = bits >> 8;
+        out[2] = bits;
+        in += 4;
+        out += 3;
+    }
+
+    // Two or three digits left without their padding
+    if (left) {
+        quint32 bits = 0;
+        for (qsizetype i = 0; i < left; ++i) {
+            bits |= quint32(base64.values[in[i]]) << (18 - 6 * i);
+        }
+        out[0] = bits >> 16;
+        if (left == 3) {
+            out[1] = bits >> 8;
+        }
+    }
+
+    *ok = true;
+    return result;
+}
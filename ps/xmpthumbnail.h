@@ -0,0 +1,51 @@
+/*  This file is part of the KDE libraries
+    SPDX-FileCopyrightText: 2026 the kdegraphics-thumbnailers authors
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _XMPTHUMBNAIL_H_
+#define _XMPTHUMBNAIL_H_
+
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+/**
+ * The thumbnails Adobe applications store in the XMP metadata of .ai,
+ * PDF and EPS files: base64 JPEG images, as xmpGImg:image items of
+ * xmp:Thumbnails.
+ */
+namespace XMPThumbnail
+{
+/**
+ * The first thumbnail in the XMP packets of @p data, scaled down to fit
+ * @p size while it is decoded, or a null image.
+ */
+QImage fromData(const QByteArray &data, const QSize &size);
+
+/**
+ * The thumbnail of the PostScript or EPS file at @p path, from the
+ * packet of the document in its DSC header and prolog, which end at
+ * @p headerEnd if known, else 0. The packets of placed art come later.
+ */
+QImage fromPostScript(const QString &path, qint64 headerEnd, const QSize &size);
+
+/**
+ * The thumbnail of the PDF file at @p path, from the metadata stream
+ * of its catalog. Unless @p readTail, only the head of the file is
+ * read, which holds the catalog of linearized files, and it is not
+ * looked for elsewhere. Compressed metadata streams, objects in object
+ * streams and cross-reference streams are not looked into.
+ */
+QImage fromPDF(const QString &path, bool readTail, const QSize &size);
+
+/**
+ * Decode base64 as written in XMP, where line breaks are character
+ * references and may be mixed with white space.
+ */
+QByteArray decodeBase64(const QByteArray &text, bool *ok);
+}
+
+#endif
@@ -13,6 +13,8 @@
 
 #include <KPluginFactory>
 
+#include "trace.h"
+
 K_PLUGIN_CLASS_WITH_JSON(RAWCreator, "rawthumbnail.json")
 
 RAWCreator::RAWCreator(QObject *parent, const QVariantList &args)
@@ -28,20 +30,30 @@ KIO::ThumbnailResult RAWCreator::create(const KIO::ThumbnailRequest &request)
 {
     //load the image into the QByteArray
     QByteArray data;
+    TraceSpan extractSpan("raw", "preview-extract");
     bool loaded=KDcrawIface::KDcraw::loadEmbeddedPreview(data,request.url().toLocalFile());
+    extractSpan.addBytes(data.size());
+    extractSpan.end();
 
     if (!loaded) {
         return KIO::ThumbnailResult::fail();
     }
     //Load the image into a QImage
     QImage preview;
+    TraceSpan decodeSpan("raw", "jpeg-decode");
+    decodeSpan.addBytes(data.size());
     if (!preview.loadFromData(data) || preview.isNull())
         return KIO::ThumbnailResult::fail();
+    decodeSpan.end();
 
     //And its EXIF info
     KExiv2Iface::KExiv2 exiv;
-    if (exiv.loadFromData(data))
+    TraceSpan exivSpan("raw", "exiv2-parse");
+    const bool exivLoaded = exiv.loadFromData(data);
+    exivSpan.end();
+    if (exivLoaded)
     {
+        TraceSpan rotateSpan("raw", "rotate");
         //We managed reading the EXIF info, rotate the image
         //according to the EXIF orientation flag
         KExiv2Iface::KExiv2::ImageOrientation orient=exiv.getImageOrientation();
@@ -81,7 +93,9 @@ KIO::ThumbnailResult RAWCreator::create(const KIO::ThumbnailRequest &request)
     }
 
     //Scale the image as requested by the thumbnailer
+    TraceSpan scaleSpan("raw", "scale");
     QImage img=preview.scaled(request.targetSize(),Qt::KeepAspectRatio);
+    scaleSpan.end();
 
     return KIO::ThumbnailResult::pass(img);
 }